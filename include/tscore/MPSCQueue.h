@@ -0,0 +1,98 @@
+/** @file
+
+  Intrusive lock free queue with many producers and a single consumer.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/List.h"
+
+/** A FIFO of items linked through their @a L link, the node based queue of Vyukov.
+
+    Pushing is a single atomic exchange, which never fails or retries however many threads push
+    at the same time. Only one thread may pop. An item is in the queue as soon as it is pushed but
+    the consumer sees it only after the pushing thread linked it to the item before it, which it
+    does right after the exchange. Until then @c pop returns @c nullptr and @c empty returns @c false,
+    so a consumer that checks @c empty before it blocks does not miss it.
+
+    The queue keeps a @a C of its own to mark the end when it has no items, so @a C has to be
+    default constructible.
+ */
+template <class C, class L = typename C::Link_link> class MPSCQueue
+{
+public:
+  MPSCQueue() { L::next_link(&_stub) = nullptr; }
+  MPSCQueue(const MPSCQueue &) = delete;
+  MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+  /// Add @a c at the end, from any thread.
+  void
+  push(C *c)
+  {
+    __atomic_store_n(&L::next_link(c), nullptr, __ATOMIC_RELAXED);
+    C *prev = __atomic_exchange_n(&_head, c, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&L::next_link(prev), c, __ATOMIC_RELEASE);
+  }
+
+  /// Take the first item, @c nullptr if there is none that is completely pushed. Only the consumer may pop.
+  C *
+  pop()
+  {
+    C *tail = _tail;
+    C *next = __atomic_load_n(&L::next_link(tail), __ATOMIC_ACQUIRE);
+
+    if (tail == &_stub) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      _tail = tail = next;
+      next         = __atomic_load_n(&L::next_link(tail), __ATOMIC_ACQUIRE);
+    }
+    if (next) {
+      _tail = next;
+      return tail;
+    }
+    if (tail != __atomic_load_n(&_head, __ATOMIC_ACQUIRE)) {
+      return nullptr; // A push behind @a tail is not linked yet.
+    }
+    // @a tail is the last item, put the stub behind it so it can be taken.
+    this->push(&_stub);
+    next = __atomic_load_n(&L::next_link(tail), __ATOMIC_ACQUIRE);
+    if (next) {
+      _tail = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+  /// Whether no item is in the queue, including ones still being pushed. Only the consumer may check.
+  bool
+  empty()
+  {
+    return _tail == &_stub && __atomic_load_n(&L::next_link(&_stub), __ATOMIC_ACQUIRE) == nullptr &&
+           __atomic_load_n(&_head, __ATOMIC_SEQ_CST) == &_stub;
+  }
+
+private:
+  C _stub;
+  C *_head = &_stub; ///< Last pushed, where producers add.
+  C *_tail = &_stub; ///< Next to pop, consumer only.
+};
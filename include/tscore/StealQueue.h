@@ -0,0 +1,92 @@
+/** @file
+
+  Bounded queue with a single producer and stealing consumers.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/** A bounded FIFO of pointers, filled by its owner and emptied by any thread.
+
+    This is the work stealing deque of Chase and Lev without the owner end pop: the owner pushes
+    at the bottom and everyone, the owner included, takes from the top with a compare and swap.
+    Taking from the top keeps the items in the order they were pushed, which callers of the event
+    system expect, at the price of a compare and swap for the owner.
+
+    @a N must be a power of 2. A slot is reused only after the item in it was taken, a thread that
+    read a slot just before it was reused fails its compare and swap and drops what it read.
+ */
+template <class T, uint32_t N> class StealQueue
+{
+  static_assert(N > 0 && (N & (N - 1)) == 0, "StealQueue size must be a power of 2");
+
+public:
+  /// Add @a t at the bottom, return @c false if the queue is full. Only the owner may push.
+  bool
+  push(T *t)
+  {
+    uint64_t b = _bottom.load(std::memory_order_relaxed);
+    if (b - _top.load(std::memory_order_acquire) >= N) {
+      return false;
+    }
+    _slot[b & (N - 1)].store(t, std::memory_order_relaxed);
+    _bottom.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Take the item at the top, @c nullptr if the queue is empty.
+  T *
+  take()
+  {
+    uint64_t t = _top.load(std::memory_order_acquire);
+    for (;;) {
+      if (t >= _bottom.load(std::memory_order_acquire)) {
+        return nullptr;
+      }
+      T *item = _slot[t & (N - 1)].load(std::memory_order_relaxed);
+      if (_top.compare_exchange_weak(t, t + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return item;
+      }
+    }
+  }
+
+  /// The number of items, which may be stale by the time it is used unless the caller is the owner and no one steals.
+  uint32_t
+  size() const
+  {
+    uint64_t t = _top.load(std::memory_order_acquire);
+    uint64_t b = _bottom.load(std::memory_order_acquire);
+    return b > t ? b - t : 0;
+  }
+
+  bool
+  empty() const
+  {
+    return this->size() == 0;
+  }
+
+private:
+  alignas(64) std::atomic<uint64_t> _top{0};
+  alignas(64) std::atomic<uint64_t> _bottom{0};
+  std::atomic<T *> _slot[N] = {};
+};
@@ -0,0 +1,216 @@
+/** @file
+
+  Hierarchical timing wheel.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "tscore/ink_assert.h"
+#include "tscore/ink_hrtime.h"
+#include "tscore/List.h"
+
+/** Per item state of a @c TimerWheel, a member of the items.
+ */
+template <class C> struct TimerWheelLink {
+  C *next       = nullptr;
+  C *prev       = nullptr;
+  ink_hrtime at = 0; ///< When the item is due, 0 if it is not in a wheel.
+  uint32_t slot = 0; ///< Index of the slot the item is in.
+};
+
+/** A hierarchical timing wheel of intrusive items.
+
+    Time is counted in ticks. The first level has a slot for each of the next
+    @c SLOTS ticks, every further level has slots @c SLOTS times as long as the
+    level below. Items are put in the lowest level that reaches their due time
+    and moved down a level when the wheel reaches their slot. Scheduling and
+    canceling an item takes constant time, advancing the wheel takes time
+    proportional to the ticks passed and the items which are due.
+
+    Items due further ahead than the wheel reaches are put in the last slot of
+    the top level and come out early, callers have to check whether an item is
+    really due.
+
+    @a C has to have a @c TimerWheelLink<C> member @a F.
+ */
+template <class C, TimerWheelLink<C> C::*F> class TimerWheel
+{
+public:
+  static constexpr int BITS   = 8;
+  static constexpr int SLOTS  = 1 << BITS;
+  static constexpr int LEVELS = 4;
+
+  /// Start counting ticks of @a tick at @a now.
+  void init(ink_hrtime tick, ink_hrtime now);
+
+  /// Schedule @a c at @a at, moving it if it is scheduled already. Items due before the next tick are due at the next tick.
+  void schedule(C *c, ink_hrtime at);
+  /// Take @a c out of the wheel, if it is in.
+  void cancel(C *c);
+  /// When @a c is due, 0 if @a c is not in the wheel.
+  static ink_hrtime due(const C *c);
+
+  /// Move the wheel to @a now, taking out the items due and calling @a expired on each of them.
+  /// @a expired may schedule and cancel items.
+  template <class Fn> int advance(ink_hrtime now, Fn &&expired);
+
+  size_t
+  size() const
+  {
+    return _count;
+  }
+
+  ink_hrtime
+  tick() const
+  {
+    return _tick;
+  }
+
+private:
+  struct Links {
+    static C *&
+    next_link(C *c)
+    {
+      return (c->*F).next;
+    }
+    static C *&
+    prev_link(C *c)
+    {
+      return (c->*F).prev;
+    }
+    static const C *
+    next_link(const C *c)
+    {
+      return (c->*F).next;
+    }
+    static const C *
+    prev_link(const C *c)
+    {
+      return (c->*F).prev;
+    }
+  };
+
+  void _place(C *c, uint64_t earliest);
+
+  DLL<C, Links> _slots[LEVELS * SLOTS];
+  ink_hrtime _tick = HRTIME_MSECOND;
+  uint64_t _now    = 0; ///< The last tick whose items were taken out.
+  size_t _count    = 0;
+};
+
+template <class C, TimerWheelLink<C> C::*F>
+inline void
+TimerWheel<C, F>::init(ink_hrtime tick, ink_hrtime now)
+{
+  ink_assert(_count == 0 && tick > 0);
+  _tick = tick;
+  _now  = now / tick;
+}
+
+template <class C, TimerWheelLink<C> C::*F>
+inline ink_hrtime
+TimerWheel<C, F>::due(const C *c)
+{
+  return (c->*F).at;
+}
+
+template <class C, TimerWheelLink<C> C::*F>
+inline void
+TimerWheel<C, F>::_place(C *c, uint64_t earliest)
+{
+  constexpr uint64_t reach = uint64_t(1) << (BITS * LEVELS);
+
+  uint64_t tick  = ((c->*F).at + _tick - 1) / _tick;
+  uint64_t delta = tick > earliest ? tick - _now : earliest - _now;
+  if (delta >= reach) {
+    delta = reach - 1;
+  }
+  tick      = _now + delta;
+  int level = 0;
+  while (delta >= (uint64_t(1) << (BITS * (level + 1)))) {
+    ++level;
+  }
+  (c->*F).slot = level * SLOTS + ((tick >> (BITS * level)) & (SLOTS - 1));
+  _slots[(c->*F).slot].push(c);
+}
+
+template <class C, TimerWheelLink<C> C::*F>
+inline void
+TimerWheel<C, F>::schedule(C *c, ink_hrtime at)
+{
+  if ((c->*F).at) {
+    _slots[(c->*F).slot].remove(c);
+  } else {
+    ++_count;
+  }
+  (c->*F).at = at > 0 ? at : 1;
+  _place(c, _now + 1);
+}
+
+template <class C, TimerWheelLink<C> C::*F>
+inline void
+TimerWheel<C, F>::cancel(C *c)
+{
+  if ((c->*F).at) {
+    _slots[(c->*F).slot].remove(c);
+    (c->*F).at = 0;
+    --_count;
+  }
+}
+
+template <class C, TimerWheelLink<C> C::*F>
+template <class Fn>
+inline int
+TimerWheel<C, F>::advance(ink_hrtime now, Fn &&expired)
+{
+  uint64_t target = now / _tick;
+  int n           = 0;
+
+  while (_now < target) {
+    if (_count == 0) {
+      _now = target;
+      break;
+    }
+    ++_now;
+    // Move the items of the slots reached down, from the top so that an item
+    // moved down to a slot reached on a lower level moves on at once.
+    for (int level = LEVELS - 1; level > 0; --level) {
+      if (_now & ((uint64_t(1) << (BITS * level)) - 1)) {
+        continue;
+      }
+      DLL<C, Links> &slot = _slots[level * SLOTS + ((_now >> (BITS * level)) & (SLOTS - 1))];
+      while (C *c = slot.pop()) {
+        _place(c, _now);
+      }
+    }
+    // Items scheduled by @a expired are due at a later tick, never in this slot.
+    DLL<C, Links> &slot = _slots[_now & (SLOTS - 1)];
+    while (C *c = slot.pop()) {
+      (c->*F).at = 0;
+      --_count;
+      ++n;
+      expired(c);
+    }
+  }
+  return n;
+}
@@ -164,12 +164,19 @@ union head_p {
 #error "unsupported processor"
 #endif
 
+// The free items of a list that live on one NUMA node, on a cache line of its own.
+struct alignas(64) InkFreeListNode {
+  head_p head;
+  uint32_t allocated;
+};
+
 struct _InkFreeList {
   head_p head;
   const char *name;
   uint32_t type_size, chunk_size, used, allocated, alignment;
   uint32_t allocated_base, used_base;
   int advice;
+  InkFreeListNode *nodes; // One per NUMA node if the free lists are NUMA aware, else nullptr.
 };
 
 typedef struct ink_freelist_ops InkFreeListOps;
@@ -179,6 +186,15 @@ const InkFreeListOps *ink_freelist_malloc_ops();
 const InkFreeListOps *ink_freelist_freelist_ops();
 void ink_freelist_init_ops(int nofl_class, int nofl_proxy);
 
+/*
+ * With more than one NUMA node, every free list keeps the items of each node apart
+ * and a thread allocates from the node set with ink_freelist_set_thread_node(). New
+ * chunks are bound to that node. This must be called at startup before other threads
+ * use the free lists, threads which never set a node use the shared list.
+ */
+void ink_freelist_init_numa(int nodes);
+void ink_freelist_set_thread_node(int node);
+
 /*
  * alignment must be a power of 2
  */
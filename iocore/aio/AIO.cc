@@ -25,11 +25,13 @@
  * Async Disk IO operations.
  */
 
+#include <atomic>
+
 #include <tscore/TSSystemState.h>
 
 #include "P_AIO.h"
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
 #define AIO_PERIOD -HRTIME_MSECONDS(10)
 #else
 
@@ -48,9 +50,28 @@ int num_filedes = 1;
 static ink_mutex insert_mutex;
 
 int thread_is_created = 0;
-#endif // AIO_MODE == AIO_MODE_NATIVE
+#endif // AIO_MODE != AIO_MODE_THREAD
 RecInt cache_config_threads_per_disk = 12;
 RecInt api_config_threads_per_disk   = 12;
+#if AIO_MODE == AIO_MODE_IO_URING
+RecInt cache_config_io_uring_entries = 1024;
+
+/* Buffers and file descriptors registered with every event thread's ring.
+
+   Entries are only ever appended, so a registration index stays valid for the life of the process
+   and a ring that has applied the first N entries can keep using them while more are added. A
+   buffer that is unregistered is only marked dead, it stays registered with the rings but is no
+   longer used for fixed buffer requests.
+ */
+#define MAX_AIO_REGISTERED 1024
+
+static ink_mutex registry_mutex;
+static iovec registered_buffers[MAX_AIO_REGISTERED];
+static std::atomic<bool> registered_buffer_live[MAX_AIO_REGISTERED];
+static int registered_fds[MAX_AIO_REGISTERED];
+static std::atomic<int> n_registered_buffers{0};
+static std::atomic<int> n_registered_fds{0};
+#endif
 
 RecRawStatBlock *aio_rsb      = nullptr;
 Continuation *aio_err_callbck = nullptr;
@@ -158,7 +179,7 @@ ink_aio_init(ts::ModuleVersion v)
                      (int)AIO_STAT_KB_READ_PER_SEC, aio_stats_cb);
   RecRegisterRawStat(aio_rsb, RECT_PROCESS, "proxy.process.cache.KB_write_per_sec", RECD_FLOAT, RECP_PERSISTENT,
                      (int)AIO_STAT_KB_WRITE_PER_SEC, aio_stats_cb);
-#if AIO_MODE != AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_THREAD
   memset(&aio_reqs, 0, MAX_DISKS_POSSIBLE * sizeof(AIO_Reqs *));
   ink_mutex_init(&insert_mutex);
 #endif
@@ -166,6 +187,11 @@ ink_aio_init(ts::ModuleVersion v)
 #if TS_USE_LINUX_NATIVE_AIO
   Warning("Running with Linux AIO, there are known issues with this feature");
 #endif
+#if AIO_MODE == AIO_MODE_IO_URING
+  REC_ReadConfigInteger(cache_config_io_uring_entries, "proxy.config.cache.io_uring.entries");
+  ink_mutex_init(&registry_mutex);
+  Note("Running with Linux io_uring AIO, %" PRId64 " entries per event thread", cache_config_io_uring_entries);
+#endif
 }
 
 int
@@ -178,7 +204,26 @@ ink_aio_start()
   return 0;
 }
 
-#if AIO_MODE != AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_IO_URING
+int
+ink_aio_register_buffer(void * /* buf ATS_UNUSED */, size_t /* len ATS_UNUSED */)
+{
+  return -1;
+}
+
+void
+ink_aio_unregister_buffer(void * /* buf ATS_UNUSED */)
+{
+}
+
+int
+ink_aio_register_fd(int /* fd ATS_UNUSED */)
+{
+  return -1;
+}
+#endif
+
+#if AIO_MODE == AIO_MODE_THREAD
 
 static void *aio_thread_main(void *arg);
 
@@ -491,7 +536,7 @@ aio_thread_main(void *arg)
   }
   return nullptr;
 }
-#else
+#elif AIO_MODE == AIO_MODE_NATIVE
 int
 DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
 {
@@ -647,4 +692,281 @@ ink_aio_writev(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
   }
   return 1;
 }
-#endif // AIO_MODE != AIO_MODE_NATIVE
+#else // AIO_MODE == AIO_MODE_IO_URING
+
+int
+ink_aio_register_buffer(void *buf, size_t len)
+{
+  ink_scoped_mutex_lock lock(registry_mutex);
+  int n = n_registered_buffers.load(std::memory_order_relaxed);
+  if (n >= MAX_AIO_REGISTERED) {
+    return -1;
+  }
+  registered_buffers[n].iov_base = buf;
+  registered_buffers[n].iov_len  = len;
+  registered_buffer_live[n].store(true, std::memory_order_relaxed);
+  n_registered_buffers.store(n + 1, std::memory_order_release);
+  return n;
+}
+
+void
+ink_aio_unregister_buffer(void *buf)
+{
+  ink_scoped_mutex_lock lock(registry_mutex);
+  int n = n_registered_buffers.load(std::memory_order_relaxed);
+  for (int i = 0; i < n; ++i) {
+    if (registered_buffers[i].iov_base == buf) {
+      registered_buffer_live[i].store(false, std::memory_order_release);
+    }
+  }
+}
+
+int
+ink_aio_register_fd(int fd)
+{
+  ink_scoped_mutex_lock lock(registry_mutex);
+  int n = n_registered_fds.load(std::memory_order_relaxed);
+  for (int i = 0; i < n; ++i) {
+    if (registered_fds[i] == fd) {
+      return i;
+    }
+  }
+  if (n >= MAX_AIO_REGISTERED) {
+    return -1;
+  }
+  registered_fds[n] = fd;
+  n_registered_fds.store(n + 1, std::memory_order_release);
+  return n;
+}
+
+DiskHandler::DiskHandler() : max_in_flight(cache_config_io_uring_entries)
+{
+  SET_HANDLER(&DiskHandler::startAIOEvent);
+  int ret = io_uring_queue_init(cache_config_io_uring_entries, &ring, 0);
+  if (ret < 0) {
+    Fatal("io_uring_queue_init(%" PRId64 ") failed: %s (%d)", cache_config_io_uring_entries, strerror(-ret), -ret);
+  }
+}
+
+DiskHandler::~DiskHandler()
+{
+  io_uring_queue_exit(&ring);
+}
+
+int
+DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
+{
+  SET_HANDLER(&DiskHandler::mainAIOEvent);
+  e->schedule_every(AIO_PERIOD);
+  trigger_event = e;
+#ifdef HAVE_EVENTFD
+  int ret = io_uring_register_eventfd(&ring, e->ethread->evfd);
+  if (ret < 0) {
+    Debug("aio", "io_uring_register_eventfd failed: %s (%d)", strerror(-ret), -ret);
+  }
+#endif
+  return EVENT_CONT;
+}
+
+/* Bring the ring's registered buffers and files up to date with the registry. This is done only
+   from the owning thread and only when nothing is pending in the submission queue. */
+void
+DiskHandler::update_registrations()
+{
+  int nb = n_registered_buffers.load(std::memory_order_acquire);
+  if (nb != buffers_seen) {
+    if (buffers_applied > 0) {
+      io_uring_unregister_buffers(&ring);
+      buffers_applied = 0;
+    }
+    int ret = io_uring_register_buffers(&ring, registered_buffers, nb);
+    if (ret < 0) {
+      Debug("aio", "io_uring_register_buffers(%d) failed: %s (%d)", nb, strerror(-ret), -ret);
+    } else {
+      buffers_applied = nb;
+    }
+    buffers_seen = nb;
+  }
+
+  int nf = n_registered_fds.load(std::memory_order_acquire);
+  if (nf != fds_seen) {
+    if (fds_applied > 0) {
+      io_uring_unregister_files(&ring);
+      fds_applied = 0;
+    }
+    int ret = io_uring_register_files(&ring, registered_fds, nf);
+    if (ret < 0) {
+      Debug("aio", "io_uring_register_files(%d) failed: %s (%d)", nf, strerror(-ret), -ret);
+    } else {
+      fds_applied = nf;
+    }
+    fds_seen = nf;
+  }
+}
+
+/* Fill in a submission queue entry for @a op, using the registered file and buffer if possible. */
+bool
+DiskHandler::prep(AIOCallback *op)
+{
+  io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+  if (sqe == nullptr) {
+    return false;
+  }
+
+  ink_aiocb *a   = &op->aiocb;
+  int fd         = a->aio_fildes;
+  unsigned flags = 0;
+  for (int i = 0; i < fds_applied; ++i) {
+    if (registered_fds[i] == a->aio_fildes) {
+      fd = i;
+      flags |= IOSQE_FIXED_FILE;
+      break;
+    }
+  }
+
+  int buf_index = -1;
+  char *buf     = static_cast<char *>(a->aio_buf);
+  for (int i = 0; i < buffers_applied; ++i) {
+    char *base = static_cast<char *>(registered_buffers[i].iov_base);
+    if (buf >= base && buf + a->aio_nbytes <= base + registered_buffers[i].iov_len &&
+        registered_buffer_live[i].load(std::memory_order_acquire)) {
+      buf_index = i;
+      break;
+    }
+  }
+
+  if (a->aio_lio_opcode == LIO_READ) {
+    if (buf_index >= 0) {
+      io_uring_prep_read_fixed(sqe, fd, a->aio_buf, a->aio_nbytes, a->aio_offset, buf_index);
+    } else {
+      io_uring_prep_read(sqe, fd, a->aio_buf, a->aio_nbytes, a->aio_offset);
+    }
+  } else {
+    if (buf_index >= 0) {
+      io_uring_prep_write_fixed(sqe, fd, a->aio_buf, a->aio_nbytes, a->aio_offset, buf_index);
+    } else {
+      io_uring_prep_write(sqe, fd, a->aio_buf, a->aio_nbytes, a->aio_offset);
+    }
+  }
+  io_uring_sqe_set_flags(sqe, flags);
+  io_uring_sqe_set_data(sqe, op);
+  return true;
+}
+
+int
+DiskHandler::mainAIOEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  AIOCallback *op = nullptr;
+
+  update_registrations();
+
+  io_uring_cqe *cqes[MAX_AIO_EVENTS];
+  unsigned ret;
+  while ((ret = io_uring_peek_batch_cqe(&ring, cqes, MAX_AIO_EVENTS)) > 0) {
+    for (unsigned i = 0; i < ret; ++i) {
+      op             = static_cast<AIOCallback *>(io_uring_cqe_get_data(cqes[i]));
+      op->aio_result = cqes[i]->res;
+      ink_assert(op->action.continuation);
+      if (op->aiocb.aio_lio_opcode == LIO_WRITE) {
+        aio_num_write++;
+        aio_bytes_written += op->aiocb.aio_nbytes;
+      } else {
+        aio_num_read++;
+        aio_bytes_read += op->aiocb.aio_nbytes;
+      }
+      complete_list.enqueue(op);
+    }
+    io_uring_cq_advance(&ring, ret);
+    in_flight -= ret;
+  }
+
+  // Everything queued since the last loop iteration goes out in a single submit.
+  while (in_flight < max_in_flight && (op = ready_list.head) != nullptr && prep(op)) {
+    ready_list.dequeue();
+    ++in_flight;
+  }
+
+  if (io_uring_sq_ready(&ring) > 0) {
+    int sret;
+    do {
+      sret = io_uring_submit(&ring);
+    } while (sret == -EINTR);
+
+    // Anything not accepted by the kernel (e.g. -EBUSY) stays in the submission queue for the next pass.
+    if (sret < 0) {
+      Debug("aio", "io_uring_submit failed: %s (%d)", strerror(-sret), -sret);
+    }
+  }
+
+  while ((op = complete_list.dequeue()) != nullptr) {
+    op->mutex = op->action.mutex;
+    MUTEX_TRY_LOCK(lock, op->mutex, trigger_event->ethread);
+    if (!lock.is_locked()) {
+      trigger_event->ethread->schedule_imm(op);
+    } else {
+      op->handleEvent(EVENT_NONE, nullptr);
+    }
+  }
+  return EVENT_CONT;
+}
+
+/* Queue every request in the @c then chain starting at @a op. If there is more than one they
+   complete as a single unit through an @c AIOVec. */
+static void
+aio_queue_chain(AIOCallback *op, int opcode)
+{
+  EThread *t      = this_ethread();
+  DiskHandler *dh = t->diskHandler;
+  AIOCallback *io = op;
+  int sz          = 0;
+
+  ink_assert(dh);
+  while (io) {
+    io->aiocb.aio_lio_opcode = opcode;
+    dh->ready_list.enqueue(io);
+    ++sz;
+    io = io->then;
+  }
+
+  if (sz > 1) {
+    ink_assert(op->action.continuation);
+    AIOVec *vec = new AIOVec(sz, op);
+    while (--sz >= 0) {
+      op->action = vec;
+      op         = op->then;
+    }
+  }
+}
+
+int
+ink_aio_read(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  op->aiocb.aio_lio_opcode = LIO_READ;
+  this_ethread()->diskHandler->ready_list.enqueue(op);
+
+  return 1;
+}
+
+int
+ink_aio_write(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  op->aiocb.aio_lio_opcode = LIO_WRITE;
+  this_ethread()->diskHandler->ready_list.enqueue(op);
+
+  return 1;
+}
+
+int
+ink_aio_readv(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  aio_queue_chain(op, LIO_READ);
+  return 1;
+}
+
+int
+ink_aio_writev(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  aio_queue_chain(op, LIO_WRITE);
+  return 1;
+}
+#endif // AIO_MODE == AIO_MODE_THREAD
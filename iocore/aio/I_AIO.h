@@ -40,9 +40,12 @@ static constexpr ts::ModuleVersion AIO_MODULE_PUBLIC_VERSION(1, 0, ts::ModuleVer
 
 #define AIO_MODE_THREAD 0
 #define AIO_MODE_NATIVE 1
+#define AIO_MODE_IO_URING 2
 
 #if TS_USE_LINUX_NATIVE_AIO
 #define AIO_MODE AIO_MODE_NATIVE
+#elif TS_USE_LINUX_IO_URING
+#define AIO_MODE AIO_MODE_IO_URING
 #else
 #define AIO_MODE AIO_MODE_THREAD
 #endif
@@ -77,10 +80,20 @@ struct ink_aiocb {
   int aio__pad[1];        /* extension padding */
 };
 
+#if AIO_MODE == AIO_MODE_IO_URING
+
+#include <liburing.h>
+
+#define MAX_AIO_EVENTS 1024
+
+#else
+
 bool ink_aio_thread_num_set(int thread_num);
 
 #endif
 
+#endif
+
 // AIOCallback::thread special values
 #define AIO_CALLBACK_THREAD_ANY ((EThread *)0) // any regular event thread
 #define AIO_CALLBACK_THREAD_AIO ((EThread *)-1)
@@ -98,7 +111,7 @@ struct AIOCallback : public Continuation {
   AIOCallback() {}
 };
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
 
 struct AIOVec : public Continuation {
   Action action;
@@ -115,6 +128,10 @@ struct AIOVec : public Continuation {
   int mainEvent(int event, Event *e);
 };
 
+#endif
+
+#if AIO_MODE == AIO_MODE_NATIVE
+
 struct DiskHandler : public Continuation {
   Event *trigger_event;
   io_context_t ctx;
@@ -133,6 +150,45 @@ struct DiskHandler : public Continuation {
     }
   }
 };
+
+#elif AIO_MODE == AIO_MODE_IO_URING
+
+/**
+  Per event thread io_uring.
+
+  Requests are queued on @a ready_list by the ink_aio_* calls and are turned into submission queue
+  entries by @c mainAIOEvent, which runs as a poll (negative) event at the tail of every event loop
+  iteration. All requests queued during an iteration are therefore submitted with a single
+  io_uring_submit() call. Completions are signalled on the thread's event fd so a sleeping thread
+  wakes up to reap them.
+
+  Buffers and file descriptors registered with @c ink_aio_register_buffer and
+  @c ink_aio_register_fd are registered with the ring from the owning thread, after which requests
+  that target them use the fixed buffer / fixed file variants.
+ */
+struct DiskHandler : public Continuation {
+  Event *trigger_event = nullptr;
+  io_uring ring;
+  bool ring_ok  = false;
+  int in_flight = 0; ///< Requests submitted to the ring but not yet completed.
+  int max_in_flight;
+
+  int buffers_seen    = 0; ///< Number of registry buffers considered for registration.
+  int buffers_applied = 0; ///< Number of registry buffers registered with @a ring.
+  int fds_seen        = 0; ///< Number of registry file descriptors considered for registration.
+  int fds_applied     = 0; ///< Number of registry file descriptors registered with @a ring.
+
+  Que(AIOCallback, link) ready_list;
+  Que(AIOCallback, link) complete_list;
+  int startAIOEvent(int event, Event *e);
+  int mainAIOEvent(int event, Event *e);
+  DiskHandler();
+  ~DiskHandler() override;
+
+private:
+  void update_registrations();
+  bool prep(AIOCallback *op);
+};
 #endif
 
 void ink_aio_init(ts::ModuleVersion version);
@@ -146,3 +202,27 @@ int ink_aio_readv(AIOCallback *op,
                   int fromAPI = 0); // fromAPI is a boolean to indicate if this is from a API call such as upload proxy feature
 int ink_aio_writev(AIOCallback *op, int fromAPI = 0);
 AIOCallback *new_AIOCallback();
+
+/** Register a long lived I/O buffer, e.g. a volume aggregation buffer.
+
+    In io_uring mode requests that fall entirely within a registered buffer are issued against the
+    kernel's pinned copy of the buffer mapping. This is a no-op in the other modes.
+
+    @return The registration index, or -1 if the buffer was not registered.
+ */
+int ink_aio_register_buffer(void *buf, size_t len);
+
+/** Stop using a buffer registered with @c ink_aio_register_buffer.
+
+    This must be called before the buffer is freed.
+ */
+void ink_aio_unregister_buffer(void *buf);
+
+/** Register a long lived file descriptor, e.g. a cache disk.
+
+    In io_uring mode requests on a registered descriptor skip the per request file table lookup.
+    This is a no-op in the other modes.
+
+    @return The registration index, or -1 if the descriptor was not registered.
+ */
+int ink_aio_register_fd(int fd);
@@ -46,13 +46,15 @@ AIOCallback::ok()
 
 extern Continuation *aio_err_callbck;
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
 
 struct AIOCallbackInternal : public AIOCallback {
   int io_complete(int event, void *data);
   AIOCallbackInternal()
   {
+#if AIO_MODE == AIO_MODE_NATIVE
     memset((void *)&(this->aiocb), 0, sizeof(this->aiocb));
+#endif
     SET_HANDLER(&AIOCallbackInternal::io_complete);
   }
 };
@@ -74,7 +76,7 @@ AIOVec::mainEvent(int /* event */, Event *)
   return EVENT_ERROR;
 }
 
-#else /* AIO_MODE != AIO_MODE_NATIVE */
+#else /* AIO_MODE == AIO_MODE_THREAD */
 
 struct AIO_Reqs;
 
@@ -102,7 +104,7 @@ struct AIO_Reqs {
   int requests_queued = 0;
 };
 
-#endif // AIO_MODE == AIO_MODE_NATIVE
+#endif // AIO_MODE != AIO_MODE_THREAD
 
 TS_INLINE int
 AIOCallbackInternal::io_complete(int event, void *data)
@@ -38,6 +38,9 @@
 #include "tscore/hugepages.h"
 
 #include <atomic>
+#include <vector>
+
+#include <sys/mman.h>
 
 constexpr ts::VersionNumber CACHE_DB_VERSION(CACHE_DB_MAJOR_VERSION, CACHE_DB_MINOR_VERSION);
 
@@ -62,9 +65,24 @@ int64_t cache_config_ram_cache_size            = AUTO_SIZE_RAM_CACHE;
 int cache_config_ram_cache_algorithm           = 1;
 int cache_config_ram_cache_compress            = 0;
 int cache_config_ram_cache_compress_percent    = 90;
+int cache_config_ram_cache_compress_adaptive   = 0;
+int cache_config_ram_cache_zstd_level          = 3;
 int cache_config_ram_cache_use_seen_filter     = 1;
+int cache_config_ram_cache_zero_copy_hits      = 0;
+int cache_config_hot_objects_entries           = 0;
+int cache_config_hot_objects_max_size          = 65536;
+int cache_config_hot_objects_min_hits          = 4;
+int cache_config_hot_objects_ttl               = 5;
+int cache_config_tier_promote_hits             = 2;
+int cache_config_tier_max_size                 = 1048576;
+int cache_config_tier_demote                   = 1;
+int cache_config_tier_admit                    = 0;
 int cache_config_http_max_alts                 = 3;
 int cache_config_dir_sync_frequency            = 60;
+int cache_config_dir_sync_incremental          = 0;
+int cache_config_dir_sync_max_write            = 2 * 1024 * 1024;
+int cache_config_dir_sync_delay                = 500;
+int cache_config_dir_load_mmap                 = 0;
 int cache_config_permit_pinning                = 0;
 int cache_config_select_alternate              = 1;
 int cache_config_max_doc_size                  = 0;
@@ -76,6 +94,8 @@ int cache_config_hit_evacuate_size_limit       = 0;
 int cache_config_force_sector_size             = 0;
 int cache_config_target_fragment_size          = DEFAULT_TARGET_FRAGMENT_SIZE;
 int cache_config_agg_write_backlog             = AGG_SIZE * 2;
+int cache_config_agg_write_direct_size         = 0;
+int cache_config_agg_write_fill_time           = 0;
 int cache_config_enable_checksum               = 0;
 int cache_config_alt_rewrite_max_size          = 4096;
 int cache_config_read_while_writer             = 0;
@@ -115,6 +135,11 @@ struct VolInitInfo {
   off_t recover_pos;
   AIOCallbackInternal vol_aio[4];
   char *vol_h_f;
+  // concurrent reads of the directory, see Vol::load_dir()
+  AIOCallbackInternal *dir_aio = nullptr;
+  int dir_aio_count            = 0;
+  int dir_aio_pending          = 0;
+  bool dir_aio_failed          = false;
 
   VolInitInfo()
   {
@@ -129,11 +154,16 @@ struct VolInitInfo {
       i.action = nullptr;
       i.mutex.clear();
     }
+    for (int i = 0; i < dir_aio_count; i++) {
+      dir_aio[i].action = nullptr;
+      dir_aio[i].mutex.clear();
+    }
+    delete[] dir_aio;
     free(vol_h_f);
   }
 };
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
 struct VolInit : public Continuation {
   Vol *vol;
   char *path;
@@ -574,10 +604,10 @@ CacheProcessor::start_internal(int flags)
   ink_assert((int)TS_EVENT_CACHE_SCAN_OPERATION_FAILED == (int)CACHE_EVENT_SCAN_OPERATION_FAILED);
   ink_assert((int)TS_EVENT_CACHE_SCAN_DONE == (int)CACHE_EVENT_SCAN_DONE);
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
   int etype            = ET_NET;
-  int n_netthreads     = eventProcessor.n_threads_for_type[etype];
-  EThread **netthreads = eventProcessor.eventthread[etype];
+  int n_netthreads     = eventProcessor.thread_group[etype]._count;
+  EThread **netthreads = eventProcessor.thread_group[etype]._thread;
   for (int i = 0; i < n_netthreads; ++i) {
     netthreads[i]->diskHandler = new DiskHandler();
     netthreads[i]->schedule_imm(netthreads[i]->diskHandler);
@@ -679,7 +709,7 @@ CacheProcessor::start_internal(int flags)
 
         off_t skip = ROUND_TO_STORE_BLOCK((sd->offset < START_POS ? START_POS + sd->alignment : sd->offset));
         blocks     = blocks - (skip >> STORE_BLOCK_SHIFT);
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
         eventProcessor.schedule_imm(new DiskInit(gdisks[gndisks], path, blocks, skip, sector_size, fd, clear));
 #else
         gdisks[gndisks]->open(path, blocks, skip, sector_size, fd, clear);
@@ -904,6 +934,9 @@ CacheProcessor::cacheInitialized()
         case RAM_CACHE_ALGORITHM_LRU:
           gvol[i]->ram_cache = new_RamCacheLRU();
           break;
+        case RAM_CACHE_ALGORITHM_TINYLFU:
+          gvol[i]->ram_cache = new_RamCacheTinyLFU();
+          break;
         }
       }
       // let us calculate the Size
@@ -930,7 +963,7 @@ CacheProcessor::cacheInitialized()
           total_direntries += vol_total_direntries;
           CACHE_VOL_SUM_DYN_STAT(cache_direntries_total_stat, vol_total_direntries);
 
-          vol_used_direntries = dir_entries_used(gvol[i]);
+          vol_used_direntries = gvol[i]->init_dir_entries;
           CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, vol_used_direntries);
           used_direntries += vol_used_direntries;
         }
@@ -979,7 +1012,7 @@ CacheProcessor::cacheInitialized()
           total_direntries += vol_total_direntries;
           CACHE_VOL_SUM_DYN_STAT(cache_direntries_total_stat, vol_total_direntries);
 
-          vol_used_direntries = dir_entries_used(gvol[i]);
+          vol_used_direntries = gvol[i]->init_dir_entries;
           CACHE_VOL_SUM_DYN_STAT(cache_direntries_used_stat, vol_used_direntries);
           used_direntries += vol_used_direntries;
         }
@@ -998,9 +1031,15 @@ CacheProcessor::cacheInitialized()
       case CACHE_COMPRESSION_LIBLZMA:
 #ifndef HAVE_LZMA_H
         Fatal("lzma not available for RAM cache compression");
+#endif
+        break;
+      case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+        Fatal("zstd not available for RAM cache compression");
 #endif
         break;
       }
+      ram_cache_compress_init();
 
       GLOBAL_CACHE_SET_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_cache_bytes);
       GLOBAL_CACHE_SET_DYN_STAT(cache_bytes_total_stat, total_cache_bytes);
@@ -1173,7 +1212,9 @@ vol_init_dir(Vol *d)
 void
 vol_clear_init(Vol *d)
 {
-  size_t dir_len = d->dirlen();
+  DirSegmentWriter writer(d, -1);
+  size_t dir_len   = d->dirlen();
+  d->dir_sync_full = 2;
   memset(d->raw_dir, 0, dir_len);
   vol_init_dir(d);
   d->header->magic          = VOL_MAGIC;
@@ -1267,6 +1308,9 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   header = reinterpret_cast<VolHeaderFooter *>(raw_dir);
   footer = reinterpret_cast<VolHeaderFooter *>(raw_dir + this->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
 
+  delete[] seg_seq;
+  seg_seq = new DirSegmentSeq[segments];
+
   if (clear) {
     Note("clearing cache directory '%s'", hash_text.get());
     return clear_dir();
@@ -1295,7 +1339,7 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
     aio->thread           = AIO_CALLBACK_THREAD_ANY;
     aio->then             = (i < 3) ? &(init_info->vol_aio[i + 1]) : nullptr;
   }
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
   ink_assert(ink_aio_readv(init_info->vol_aio));
 #else
   ink_assert(ink_aio_read(init_info->vol_aio));
@@ -1334,13 +1378,102 @@ Vol::handle_dir_clear(int event, void *data)
   return EVENT_DONE;
 }
 
+/*
+   Read the directory copy at @a dir_offset into raw_dir. The read is split
+   into DIR_LOAD_SIZE pieces which are all queued at once so that several
+   AIO threads, or the kernel, can work on one large directory in parallel.
+   handle_dir_read() continues once all of them are done.
+   */
+int
+Vol::load_dir(off_t dir_offset)
+{
+  size_t dirlen = this->dirlen();
+
+  SET_HANDLER(&Vol::handle_dir_read);
+  if (cache_config_dir_load_mmap && load_dir_mmap(dir_offset)) {
+    return handle_dir_read(EVENT_IMMEDIATE, nullptr);
+  }
+
+  int n                      = (dirlen + DIR_LOAD_SIZE - 1) / DIR_LOAD_SIZE;
+  init_info->dir_aio         = new AIOCallbackInternal[n];
+  init_info->dir_aio_count   = n;
+  init_info->dir_aio_pending = n;
+  for (int i = 0; i < n; i++) {
+    AIOCallback *aio      = &init_info->dir_aio[i];
+    off_t pos             = static_cast<off_t>(i) * DIR_LOAD_SIZE;
+    aio->aiocb.aio_fildes = fd;
+    aio->aiocb.aio_buf    = raw_dir + pos;
+    aio->aiocb.aio_nbytes = std::min<size_t>(DIR_LOAD_SIZE, dirlen - pos);
+    aio->aiocb.aio_offset = dir_offset + pos;
+    aio->action           = this;
+    aio->thread           = AIO_CALLBACK_THREAD_ANY;
+    aio->then             = nullptr;
+  }
+  for (int i = 0; i < n; i++) {
+    ink_assert(ink_aio_read(&init_info->dir_aio[i]));
+  }
+  return EVENT_CONT;
+}
+
+/*
+   Copy the directory through a populated read only mapping of the disk,
+   letting the kernel read it with large requests and read ahead. Returns
+   false, leaving the read to AIO, if the mapping fails or any page of it
+   could not be read in.
+   */
+bool
+Vol::load_dir_mmap(off_t dir_offset)
+{
+#ifdef MAP_POPULATE
+  size_t dirlen = this->dirlen();
+  off_t page    = ats_pagesize();
+  off_t base    = dir_offset & ~(page - 1);
+  size_t maplen = dirlen + (dir_offset - base);
+
+  char *m = static_cast<char *>(mmap(nullptr, maplen, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, base));
+  if (m == MAP_FAILED) {
+    Warning("unable to map cache directory '%s': %s, reading it instead", hash_text.get(), strerror(errno));
+    return false;
+  }
+  // Touching a page which failed to read would raise SIGBUS, so only copy if every page is in.
+  std::vector<unsigned char> resident((maplen + page - 1) / page);
+  bool ok = mincore(m, maplen, resident.data()) == 0;
+  for (size_t i = 0; ok && i < resident.size(); i++) {
+    ok = resident[i] & 1;
+  }
+  if (ok) {
+    memcpy(raw_dir, m + (dir_offset - base), dirlen);
+    Vol *vol = this; // for the STAT macros
+    CACHE_SUM_GLOBAL_DYN_STAT(cache_directory_load_bytes_stat, dirlen);
+  } else {
+    Warning("unable to map cache directory '%s': not all pages were read, reading it instead", hash_text.get());
+  }
+  munmap(m, maplen);
+  // Don't leave a second copy of the directory in the page cache.
+  posix_fadvise(fd, base, maplen, POSIX_FADV_DONTNEED);
+  return ok;
+#else
+  (void)dir_offset;
+  return false;
+#endif
+}
+
 int
 Vol::handle_dir_read(int event, void *data)
 {
   AIOCallback *op = static_cast<AIOCallback *>(data);
+  Vol *vol        = this; // for the STAT macros
 
   if (event == AIO_EVENT_DONE) {
     if (static_cast<size_t>(op->aio_result) != op->aiocb.aio_nbytes) {
+      init_info->dir_aio_failed = true;
+    } else {
+      CACHE_SUM_GLOBAL_DYN_STAT(cache_directory_load_bytes_stat, op->aio_result);
+    }
+    if (--init_info->dir_aio_pending > 0) {
+      return EVENT_CONT;
+    }
+    if (init_info->dir_aio_failed) {
       Note("Directory read failed: clearing cache directory %s", this->hash_text.get());
       clear_dir();
       return EVENT_DONE;
@@ -1440,6 +1573,8 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
       disk->incrErrors(&io);
       goto Lclear;
     }
+    Vol *vol = this; // for the STAT macros
+    CACHE_SUM_GLOBAL_DYN_STAT(cache_directory_recover_bytes_stat, io.aio_result);
     if (io.aiocb.aio_offset == header->last_write_pos) {
       /* check that we haven't wrapped around without syncing
          the directory. Start from last_write_serial (write pos the documents
@@ -1656,7 +1791,7 @@ Ldone : {
   init_info->vol_aio[2].aiocb.aio_offset = ss + dirlen - footerlen;
 
   SET_HANDLER(&Vol::handle_recover_write_dir);
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE != AIO_MODE_THREAD
   ink_assert(ink_aio_writev(init_info->vol_aio));
 #else
   ink_assert(ink_aio_write(init_info->vol_aio));
@@ -1681,7 +1816,8 @@ Vol::handle_recover_write_dir(int /* event ATS_UNUSED */, void * /* data ATS_UNU
   delete init_info;
   init_info = nullptr;
   set_io_not_in_progress();
-  scan_pos = header->write_pos;
+  init_dir_entries = dir_entries_used(this);
+  scan_pos         = header->write_pos;
   periodic_scan();
   SET_HANDLER(&Vol::dir_init_done);
   return dir_init_done(EVENT_IMMEDIATE, nullptr);
@@ -1715,21 +1851,17 @@ Vol::handle_header_read(int event, void *data)
 
     if (hf[0]->sync_serial == hf[1]->sync_serial &&
         (hf[0]->sync_serial >= hf[2]->sync_serial || hf[2]->sync_serial != hf[3]->sync_serial)) {
-      SET_HANDLER(&Vol::handle_dir_read);
       if (is_debug_tag_set("cache_init")) {
         Note("using directory A for '%s'", hash_text.get());
       }
-      io.aiocb.aio_offset = skip;
-      ink_assert(ink_aio_read(&io));
+      return load_dir(skip);
     }
     // try B
     else if (hf[2]->sync_serial == hf[3]->sync_serial) {
-      SET_HANDLER(&Vol::handle_dir_read);
       if (is_debug_tag_set("cache_init")) {
         Note("using directory B for '%s'", hash_text.get());
       }
-      io.aiocb.aio_offset = skip + this->dirlen();
-      ink_assert(ink_aio_read(&io));
+      return load_dir(skip + this->dirlen());
     } else {
       Note("no good directory, clearing '%s' since sync_serials on both A and B copies are invalid", hash_text.get());
       Note("Header A: %d\nFooter A: %d\n Header B: %d\n Footer B %d\n", hf[0]->sync_serial, hf[1]->sync_serial, hf[2]->sync_serial,
@@ -1752,6 +1884,8 @@ Vol::dir_init_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
     eventProcessor.schedule_in(this, HRTIME_MSECONDS(5), ET_CALL);
     return EVENT_CONT;
   } else {
+    Vol *vol = this; // for the STAT macros
+    CACHE_SUM_GLOBAL_DYN_STAT(cache_directory_load_pending_stat, -1);
     int vol_no = gnvol++;
     ink_assert(!gvol[vol_no]);
     gvol[vol_no] = this;
@@ -2080,7 +2214,9 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
             blocks                      = q->b->len;
 
             bool vol_clear = clear || d->cleared || q->new_block;
-#if AIO_MODE == AIO_MODE_NATIVE
+            RecIncrGlobalRawStatSum(cache_rsb, cache_directory_load_pending_stat, 1);
+            RecIncrGlobalRawStatSum(cp->vol_rsb, cache_directory_load_pending_stat, 1);
+#if AIO_MODE != AIO_MODE_THREAD
             eventProcessor.schedule_imm(new VolInit(cp->vols[vol_no], d->path, blocks, q->b->offset, vol_clear));
 #else
             cp->vols[vol_no]->init(d->path, blocks, q->b->offset, vol_clear);
@@ -2148,6 +2284,22 @@ unmarshal_helper(Doc *doc, Ptr<IOBufferData> &buf, int &okay)
   }
 }
 
+// Classifies the alternate being read so that the RAM cache can pick a compression codec for it.
+static uint32_t
+ram_cache_content_of(CacheHTTPInfo &alternate)
+{
+  if (!cache_config_ram_cache_compress || !cache_config_ram_cache_compress_adaptive || !alternate.valid()) {
+    return RAM_CACHE_CONTENT_UNKNOWN;
+  }
+  HTTPHdr *resp            = alternate.response_get();
+  int type_len             = 0;
+  int encoding_len         = 0;
+  const char *content_type = resp->value_get(MIME_FIELD_CONTENT_TYPE, MIME_LEN_CONTENT_TYPE, &type_len);
+  const char *encoding     = resp->value_get(MIME_FIELD_CONTENT_ENCODING, MIME_LEN_CONTENT_ENCODING, &encoding_len);
+  bool encoded             = encoding && !(encoding_len == 8 && strncasecmp(encoding, "identity", 8) == 0);
+  return ram_cache_content(content_type, type_len, encoded);
+}
+
 // [amc] I think this is where all disk reads from cache funnel through here.
 int
 CacheVC::handleReadDone(int event, Event *e)
@@ -2251,7 +2403,7 @@ CacheVC::handleReadDone(int event, Event *e)
         if (cutoff_check && !f.doc_from_ram_cache) {
           uint64_t o = dir_offset(&dir);
           vol->ram_cache->put(read_key, buf.get(), doc->len, http_copy_hdr, static_cast<uint32_t>(o >> 32),
-                              static_cast<uint32_t>(o));
+                              static_cast<uint32_t>(o), ram_cache_content_of(alternate));
         }
         if (!doc_len) {
           // keep a pointer to it. In case the state machine decides to
@@ -2347,7 +2499,13 @@ Cache::lookup(Continuation *cont, const CacheKey *key, CacheFragType type, const
 
   Vol *vol          = key_to_vol(key, hostname, host_len);
   ProxyMutex *mutex = cont->mutex.get();
-  CacheVC *c        = new_CacheVC(cont);
+  if (dir_probe_miss(key, vol)) {
+    CACHE_INCREMENT_DYN_STAT(cache_lookup_failure_stat);
+    cont->handleEvent(CACHE_EVENT_LOOKUP_FAILED, nullptr);
+    return ACTION_RESULT_DONE;
+  }
+
+  CacheVC *c = new_CacheVC(cont);
   SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
   c->vio.op    = VIO::READ;
   c->base_stat = cache_lookup_active_stat;
@@ -2464,7 +2622,9 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
 
   CACHE_TRY_LOCK(lock, cont->mutex, this_ethread());
   ink_assert(lock.is_locked());
-  Vol *vol = key_to_vol(key, hostname, host_len);
+  uint32_t tier_epoch = cache_tier_epoch(key);
+  Vol *other_tier     = nullptr;
+  Vol *vol            = key_to_vol(key, hostname, host_len, &other_tier);
   // coverity[var_decl]
   Dir result;
   dir_clear(&result); // initialized here, set result empty so we can recognize missed lock
@@ -2479,6 +2639,8 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
   c->vol                = vol;
   c->dir                = result;
   c->f.remove           = 1;
+  c->tier_vol           = other_tier;
+  c->tier_epoch         = tier_epoch;
 
   SET_CONTINUATION_HANDLER(c, &CacheVC::removeEvent);
   int ret = c->removeEvent(EVENT_IMMEDIATE, nullptr);
@@ -2919,6 +3081,11 @@ cplist_reconfigure()
       }
       gnvol += cp->num_vols;
     }
+    for (config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
+      if (config_vol->cachep) {
+        config_vol->cachep->tier = config_vol->tier;
+      }
+    }
   }
   return 0;
 }
@@ -2989,54 +3156,96 @@ create_volume(int volume_number, off_t size_in_blocks, int scheme, CacheVol *cp)
   return 0;
 }
 
+static void
+rebuild_host_record(CacheHostRecord *h_rec)
+{
+  build_vol_hash_table(h_rec);
+  if (h_rec->ssd_tier) {
+    build_vol_hash_table(h_rec->ssd_tier);
+  }
+}
+
 void
 rebuild_host_table(Cache *cache)
 {
-  build_vol_hash_table(&cache->hosttable->gen_host_rec);
+  rebuild_host_record(&cache->hosttable->gen_host_rec);
   if (cache->hosttable->m_numEntries != 0) {
     CacheHostMatcher *hm   = cache->hosttable->getHostMatcher();
     CacheHostRecord *h_rec = hm->getDataArray();
     int h_rec_len          = hm->getNumElements();
     int i;
     for (i = 0; i < h_rec_len; i++) {
-      build_vol_hash_table(&h_rec[i]);
+      rebuild_host_record(&h_rec[i]);
     }
   }
 }
 
 // if generic_host_rec.vols == nullptr, what do we do???
-Vol *
-Cache::key_to_vol(const CacheKey *key, const char *hostname, int host_len)
+CacheHostRecord *
+Cache::key_to_host_record(const char *hostname, int host_len)
 {
-  uint32_t h                 = (key->slice32(2) >> DIR_TAG_WIDTH) % VOL_HASH_TABLE_SIZE;
-  unsigned short *hash_table = hosttable->gen_host_rec.vol_hash_table;
-  CacheHostRecord *host_rec  = &hosttable->gen_host_rec;
-
   if (hosttable->m_numEntries > 0 && host_len) {
     CacheHostResult res;
     hosttable->Match(hostname, host_len, &res);
-    if (res.record) {
-      unsigned short *host_hash_table = res.record->vol_hash_table;
-      if (host_hash_table) {
-        if (is_debug_tag_set("cache_hosting")) {
-          char format_str[50];
-          snprintf(format_str, sizeof(format_str), "Volume: %%xd for host: %%.%ds", host_len);
-          Debug("cache_hosting", format_str, res.record, hostname);
-        }
-        return res.record->vols[host_hash_table[h]];
+    if (res.record && res.record->vol_hash_table) {
+      if (is_debug_tag_set("cache_hosting")) {
+        char format_str[50];
+        snprintf(format_str, sizeof(format_str), "Volume: %%xd for host: %%.%ds", host_len);
+        Debug("cache_hosting", format_str, res.record, hostname);
       }
+      return res.record;
     }
   }
-  if (hash_table) {
-    if (is_debug_tag_set("cache_hosting")) {
-      char format_str[50];
-      snprintf(format_str, sizeof(format_str), "Generic volume: %%xd for host: %%.%ds", host_len);
-      Debug("cache_hosting", format_str, host_rec, hostname);
+  if (is_debug_tag_set("cache_hosting")) {
+    char format_str[50];
+    snprintf(format_str, sizeof(format_str), "Generic volume: %%xd for host: %%.%ds", host_len);
+    Debug("cache_hosting", format_str, &hosttable->gen_host_rec, hostname);
+  }
+  return &hosttable->gen_host_rec;
+}
+
+static inline Vol *
+host_record_vol(CacheHostRecord *host_rec, const CacheKey *key)
+{
+  uint32_t h = (key->slice32(2) >> DIR_TAG_WIDTH) % VOL_HASH_TABLE_SIZE;
+  return host_rec->vol_hash_table ? host_rec->vols[host_rec->vol_hash_table[h]] : host_rec->vols[0];
+}
+
+// For a tiered host record the object is in the SSD tier if that may have
+// the key, otherwise it is in the HDD tier. @a other_tier, if given, is set
+// to the volume of the tier not chosen, or nullptr if the record is not tiered.
+Vol *
+Cache::key_to_vol(const CacheKey *key, const char *hostname, int host_len, Vol **other_tier)
+{
+  CacheHostRecord *host_rec = key_to_host_record(hostname, host_len);
+  Vol *vol                  = host_record_vol(host_rec, key);
+
+  if (other_tier) {
+    *other_tier = nullptr;
+  }
+  if (host_rec->ssd_tier && host_rec->ssd_tier->vol_hash_table) {
+    Vol *ssd = host_record_vol(host_rec->ssd_tier, key);
+    if (!dir_probe_miss(key, ssd)) {
+      std::swap(vol, ssd);
+    }
+    if (other_tier) {
+      *other_tier = ssd;
     }
-    return host_rec->vols[hash_table[h]];
-  } else {
-    return host_rec->vols[0];
   }
+  return vol;
+}
+
+// The volume of @a tier for the key, or nullptr if the host record of
+// @a hostname is not tiered.
+Vol *
+Cache::key_to_tier_vol(const CacheKey *key, const char *hostname, int host_len, int tier)
+{
+  CacheHostRecord *host_rec = key_to_host_record(hostname, host_len);
+
+  if (!host_rec->ssd_tier || !host_rec->ssd_tier->vol_hash_table) {
+    return nullptr;
+  }
+  return host_record_vol(tier == CACHE_TIER_SSD ? host_rec->ssd_tier : host_rec, key);
 }
 
 static void
@@ -3061,6 +3270,15 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("ram_cache.bytes_used", cache_ram_cache_bytes_stat);
   REG_INT("ram_cache.hits", cache_ram_cache_hits_stat);
   REG_INT("ram_cache.misses", cache_ram_cache_misses_stat);
+  REG_INT("ram_cache.zero_copy", cache_ram_cache_zero_copy_stat);
+  REG_INT("ram_cache.compress_skipped", cache_ram_cache_compress_skipped_stat);
+  REG_INT("hot_objects.hits", cache_hot_object_hits_stat);
+  REG_INT("hot_objects.inserts", cache_hot_object_inserts_stat);
+  REG_INT("tier.promotions", cache_tier_promotions_stat);
+  REG_INT("tier.demotions", cache_tier_demotions_stat);
+  REG_INT("tier.move_failures", cache_tier_move_failures_stat);
+  REG_INT("agg_write.direct", cache_agg_write_direct_stat);
+  REG_INT("agg_write.direct_bytes", cache_agg_write_direct_bytes_stat);
   REG_INT("pread_count", cache_pread_count_stat);
   REG_INT("percent_full", cache_percent_full_stat);
   REG_INT("lookup.active", cache_lookup_active_stat);
@@ -3103,6 +3321,9 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("sync.count", cache_directory_sync_count_stat);
   REG_INT("sync.bytes", cache_directory_sync_bytes_stat);
   REG_INT("sync.time", cache_directory_sync_time_stat);
+  REG_INT("dir_load.pending", cache_directory_load_pending_stat);
+  REG_INT("dir_load.bytes", cache_directory_load_bytes_stat);
+  REG_INT("dir_load.recover_bytes", cache_directory_recover_bytes_stat);
   REG_INT("span.errors.read", cache_span_errors_read_stat);
   REG_INT("span.errors.write", cache_span_errors_write_stat);
   REG_INT("span.failing", cache_span_failing_stat);
@@ -3136,7 +3357,18 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_algorithm, "proxy.config.cache.ram_cache.algorithm");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress, "proxy.config.cache.ram_cache.compress");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_percent, "proxy.config.cache.ram_cache.compress_percent");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_adaptive, "proxy.config.cache.ram_cache.compress_adaptive");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_zstd_level, "proxy.config.cache.ram_cache.zstd_level");
   REC_ReadConfigInt32(cache_config_ram_cache_use_seen_filter, "proxy.config.cache.ram_cache.use_seen_filter");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_zero_copy_hits, "proxy.config.cache.ram_cache.zero_copy_hits");
+  REC_ReadConfigInt32(cache_config_hot_objects_entries, "proxy.config.cache.hot_objects.entries");
+  REC_EstablishStaticConfigInt32(cache_config_hot_objects_max_size, "proxy.config.cache.hot_objects.max_size");
+  REC_EstablishStaticConfigInt32(cache_config_hot_objects_min_hits, "proxy.config.cache.hot_objects.min_hits");
+  REC_EstablishStaticConfigInt32(cache_config_hot_objects_ttl, "proxy.config.cache.hot_objects.ttl");
+  REC_EstablishStaticConfigInt32(cache_config_tier_promote_hits, "proxy.config.cache.tier.promote_hits");
+  REC_EstablishStaticConfigInt32(cache_config_tier_max_size, "proxy.config.cache.tier.max_size");
+  REC_EstablishStaticConfigInt32(cache_config_tier_demote, "proxy.config.cache.tier.demote");
+  REC_EstablishStaticConfigInt32(cache_config_tier_admit, "proxy.config.cache.tier.admit");
 
   REC_EstablishStaticConfigInt32(cache_config_http_max_alts, "proxy.config.cache.limits.http.max_alts");
   Debug("cache_init", "proxy.config.cache.limits.http.max_alts = %d", cache_config_http_max_alts);
@@ -3151,6 +3383,18 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_dir_sync_frequency, "proxy.config.cache.dir.sync_frequency");
   Debug("cache_init", "proxy.config.cache.dir.sync_frequency = %d", cache_config_dir_sync_frequency);
 
+  REC_EstablishStaticConfigInt32(cache_config_dir_sync_incremental, "proxy.config.cache.dir.sync_incremental");
+  Debug("cache_init", "proxy.config.cache.dir.sync_incremental = %d", cache_config_dir_sync_incremental);
+
+  REC_EstablishStaticConfigInt32(cache_config_dir_sync_max_write, "proxy.config.cache.dir.sync_max_write");
+  Debug("cache_init", "proxy.config.cache.dir.sync_max_write = %d", cache_config_dir_sync_max_write);
+
+  REC_EstablishStaticConfigInt32(cache_config_dir_sync_delay, "proxy.config.cache.dir.sync_delay");
+  Debug("cache_init", "proxy.config.cache.dir.sync_delay = %d", cache_config_dir_sync_delay);
+
+  REC_ReadConfigInteger(cache_config_dir_load_mmap, "proxy.config.cache.dir.load_mmap");
+  Debug("cache_init", "proxy.config.cache.dir.load_mmap = %d", cache_config_dir_load_mmap);
+
   REC_EstablishStaticConfigInt32(cache_config_select_alternate, "proxy.config.cache.select_alternate");
   Debug("cache_init", "proxy.config.cache.select_alternate = %d", cache_config_select_alternate);
 
@@ -3189,6 +3433,12 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_agg_write_backlog, "proxy.config.cache.agg_write_backlog");
   Debug("cache_init", "proxy.config.cache.agg_write_backlog = %d", cache_config_agg_write_backlog);
 
+  REC_EstablishStaticConfigInt32(cache_config_agg_write_direct_size, "proxy.config.cache.agg_write.direct_size");
+  Debug("cache_init", "proxy.config.cache.agg_write.direct_size = %d", cache_config_agg_write_direct_size);
+
+  REC_EstablishStaticConfigInt32(cache_config_agg_write_fill_time, "proxy.config.cache.agg_write.fill_time");
+  Debug("cache_init", "proxy.config.cache.agg_write.fill_time = %d", cache_config_agg_write_fill_time);
+
   REC_EstablishStaticConfigInt32(cache_config_enable_checksum, "proxy.config.cache.enable_checksum");
   Debug("cache_init", "proxy.config.cache.enable_checksum = %d", cache_config_enable_checksum);
 
@@ -30,6 +30,7 @@
 #ifdef LOOP_CHECK_MODE
 #define DIR_LOOP_THRESHOLD 1000
 #endif
+#define DIR_PROBE_MISS_RETRIES 4
 #include "tscore/ink_stack_trace.h"
 
 #define CACHE_INC_DIR_USED(_m)                            \
@@ -62,6 +63,12 @@ OpenDir::OpenDir()
   SET_HANDLER(&OpenDir::signal_readers);
 }
 
+static inline DirSegmentSeq *
+dir_segment_seq(const CryptoHash *key, Vol *d)
+{
+  return d->seg_seq ? &d->seg_seq[key->slice32(0) % d->segments] : nullptr;
+}
+
 /*
    If allow_if_writers is false, open_write fails if there are other writers.
    max_writers sets the maximum number of concurrent writers that are
@@ -102,6 +109,9 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
   cont->od           = od;
   cont->write_vector = &od->vector;
   bucket[b].push(od);
+  if (DirSegmentSeq *ss = dir_segment_seq(&cont->first_key, cont->vol)) {
+    ss->writers.fetch_add(1, std::memory_order_release);
+  }
   return 1;
 }
 
@@ -141,6 +151,9 @@ OpenDir::close_write(CacheVC *cont)
     unsigned int h = cont->first_key.slice32(0);
     int b          = h % OPEN_DIR_BUCKETS;
     bucket[b].remove(cont->od);
+    if (DirSegmentSeq *ss = dir_segment_seq(&cont->first_key, cont->vol)) {
+      ss->writers.fetch_sub(1, std::memory_order_release);
+    }
     delayed_readers.append(cont->od->readers);
     signal_readers(0, nullptr);
     cont->od->vector.clear();
@@ -178,6 +191,45 @@ OpenDirEntry::wait(CacheVC *cont, int msec)
 // Cache Directory
 //
 
+DirSegmentWriter::DirSegmentWriter(Vol *d, int s) : vol(d), segment(s)
+{
+  if (!vol->seg_seq) {
+    return;
+  }
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  if (segment < 0) {
+    for (int i = 0; i < vol->segments; i++) {
+      ink_assert(!(vol->seg_seq[i].seq.load(std::memory_order_relaxed) & 1));
+      vol->seg_seq[i].seq.fetch_add(1, std::memory_order_relaxed);
+    }
+    owner = true;
+  } else {
+    // Only the holder of the Vol mutex changes the sequence, so an odd value means it is ours.
+    owner = !(vol->seg_seq[segment].seq.load(std::memory_order_relaxed) & 1);
+    if (owner) {
+      vol->seg_seq[segment].seq.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+DirSegmentWriter::~DirSegmentWriter()
+{
+  if (!owner) {
+    return;
+  }
+  uint32_t sync_serial = vol->header->sync_serial;
+  if (segment < 0) {
+    for (int i = 0; i < vol->segments; i++) {
+      vol->seg_seq[i].sync_serial = sync_serial;
+      vol->seg_seq[i].seq.fetch_add(1, std::memory_order_release);
+    }
+  } else {
+    vol->seg_seq[segment].sync_serial = sync_serial;
+    vol->seg_seq[segment].seq.fetch_add(1, std::memory_order_release);
+  }
+}
+
 // return value 1 means no loop
 // zero indicates loop
 int
@@ -214,6 +266,7 @@ dir_bucket_loop_check(Dir *start_dir, Dir *seg)
 void
 dir_init_segment(int s, Vol *d)
 {
+  DirSegmentWriter writer(d, s);
   d->header->freelist[s] = 0;
   Dir *seg               = d->dir_segment(s);
   int l, b;
@@ -379,6 +432,7 @@ dir_clean_bucket(Dir *b, int s, Vol *vol)
 void
 dir_clean_segment(int s, Vol *d)
 {
+  DirSegmentWriter writer(d, s);
   Dir *seg = d->dir_segment(s);
   for (int64_t i = 0; i < d->buckets; i++) {
     dir_clean_bucket(dir_bucket(i, seg), s, d);
@@ -398,14 +452,19 @@ dir_clean_vol(Vol *d)
 void
 dir_clear_range(off_t start, off_t end, Vol *vol)
 {
-  for (off_t i = 0; i < vol->buckets * DIR_DEPTH * vol->segments; i++) {
-    Dir *e = dir_index(vol, i);
-    if (!dir_token(e) && dir_offset(e) >= static_cast<int64_t>(start) && dir_offset(e) < static_cast<int64_t>(end)) {
-      CACHE_DEC_DIR_USED(vol->mutex);
-      dir_set_offset(e, 0); // delete
+  for (int s = 0; s < vol->segments; s++) {
+    DirSegmentWriter writer(vol, s);
+    Dir *seg = vol->dir_segment(s);
+    for (off_t i = 0; i < vol->buckets * DIR_DEPTH; i++) {
+      Dir *e = dir_in_seg(seg, i);
+      if (!dir_token(e) && dir_offset(e) >= static_cast<int64_t>(start) && dir_offset(e) < static_cast<int64_t>(end)) {
+        CACHE_DEC_DIR_USED(vol->mutex);
+        dir_set_offset(e, 0); // delete
+      }
     }
+    dir_clean_segment(s, vol);
   }
-  dir_clean_vol(vol);
+  CHECK_DIR(vol);
 }
 
 void
@@ -576,6 +635,7 @@ Lagain:
           ink_assert(dir_offset(e) * CACHE_BLOCK_SIZE < d->len);
           return 1;
         } else { // delete the invalid entry
+          DirSegmentWriter writer(d, s);
           CACHE_DEC_DIR_USED(d->mutex);
           e = dir_delete_entry(e, p, s, d);
           continue;
@@ -599,11 +659,58 @@ Lagain:
   return 0;
 }
 
+/*
+   Check whether @a key is certainly not in the directory, without taking the Vol mutex.
+   Returns true only if no entry in the bucket has the tag of @a key and no writer has
+   the key's segment open, false if it may be present or the segment kept changing.
+   */
+bool
+dir_probe_miss(const CacheKey *key, Vol *d)
+{
+  if (!d->seg_seq) {
+    return false;
+  }
+  int s             = key->slice32(0) % d->segments;
+  int b             = key->slice32(1) % d->buckets;
+  int entries       = d->buckets * DIR_DEPTH;
+  Dir *seg          = d->dir_segment(s);
+  DirSegmentSeq &ss = d->seg_seq[s];
+
+  for (int attempt = 0; attempt < DIR_PROBE_MISS_RETRIES; attempt++) {
+    uint32_t seq = ss.seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+      continue;
+    }
+    if (ss.writers.load(std::memory_order_acquire)) {
+      return false;
+    }
+    // The segment may be modified under us, so bound the walk and check every link.
+    bool miss = true;
+    Dir *e    = dir_bucket(b, seg);
+    if (dir_offset(e)) {
+      for (int n = 0; e; n++) {
+        int next = dir_next(e);
+        if (dir_compare_tag(e, key) || n > entries || next >= entries) {
+          miss = false;
+          break;
+        }
+        e = dir_from_offset(next, seg);
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (ss.seq.load(std::memory_order_relaxed) == seq) {
+      return miss;
+    }
+  }
+  return false;
+}
+
 int
 dir_insert(const CacheKey *key, Vol *d, Dir *to_part)
 {
   ink_assert(d->mutex->thread_holding == this_ethread());
   int s  = key->slice32(0) % d->segments, l;
+  DirSegmentWriter writer(d, s);
   int bi = key->slice32(1) % d->buckets;
   ink_assert(dir_approx_size(to_part) <= MAX_FRAG_SIZE + sizeof(Doc));
   Dir *seg = d->dir_segment(s);
@@ -659,6 +766,7 @@ dir_overwrite(const CacheKey *key, Vol *d, Dir *dir, Dir *overwrite, bool must_o
   ink_assert(d->mutex->thread_holding == this_ethread());
   int s          = key->slice32(0) % d->segments, l;
   int bi         = key->slice32(1) % d->buckets;
+  DirSegmentWriter writer(d, s);
   Dir *seg       = d->dir_segment(s);
   Dir *e         = nullptr;
   Dir *b         = dir_bucket(bi, seg);
@@ -737,6 +845,7 @@ dir_delete(const CacheKey *key, Vol *d, Dir *del)
   int b    = key->slice32(1) % d->buckets;
   Dir *seg = d->dir_segment(s);
   Dir *e = nullptr, *p = nullptr;
+  DirSegmentWriter writer(d, s);
 #ifdef LOOP_CHECK_MODE
   int loop_count = 0;
 #endif
@@ -982,6 +1091,10 @@ sync_cache_dir_on_shutdown()
       ink_assert(d->header->write_pos == d->header->agg_pos);
       d->agg_buf_pos = 0;
       d->header->write_serial++;
+      if (d->agg_buffer != d->agg_main_buffer) {
+        ats_memalign_free(d->agg_buffer);
+        d->agg_buffer = d->agg_main_buffer;
+      }
     }
 
     if (buflen < dirlen) {
@@ -1030,6 +1143,34 @@ sync_cache_dir_on_shutdown()
   }
 }
 
+/*
+   Collect the parts of the directory body changed since the copy about to be
+   overwritten was written, i.e. in the last two syncs, as store block aligned
+   ranges of offsets from the start of the directory. Must be called with the
+   Vol mutex held, after the sync serial has been incremented.
+   */
+static void
+dir_sync_dirty_ranges(Vol *vol, std::vector<std::pair<off_t, off_t>> &ranges)
+{
+  uint32_t sync_serial = vol->header->sync_serial;
+  off_t seglen         = vol->buckets * DIR_DEPTH * SIZEOF_DIR;
+  off_t body           = vol->headerlen();
+  off_t body_end       = vol->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+
+  for (int s = 0; s < vol->segments; s++) {
+    if (sync_serial - vol->seg_seq[s].sync_serial > 2) {
+      continue;
+    }
+    off_t first = body + (s * seglen) / STORE_BLOCK_SIZE * STORE_BLOCK_SIZE;
+    off_t last  = std::min<off_t>(body + ROUND_TO_STORE_BLOCK((s + 1) * seglen), body_end);
+    if (!ranges.empty() && first <= ranges.back().second) {
+      ranges.back().second = last;
+    } else {
+      ranges.emplace_back(first, last);
+    }
+  }
+}
+
 int
 CacheSync::mainEvent(int event, Event *e)
 {
@@ -1066,12 +1207,14 @@ Lrestart:
     // AIO Thread
     if (io.aio_result != static_cast<int64_t>(io.aiocb.aio_nbytes)) {
       Warning("vol write error during directory sync '%s'", gvol[vol_idx]->hash_text.get());
-      event = EVENT_NONE;
+      // This copy is now unusable, and the other copy will no longer be a base for the next one.
+      vol->dir_sync_full = 2;
+      event              = EVENT_NONE;
       goto Ldone;
     }
     CACHE_SUM_DYN_STAT(cache_directory_sync_bytes_stat, io.aio_result);
 
-    trigger = eventProcessor.schedule_in(this, SYNC_DELAY);
+    trigger = eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_dir_sync_delay));
     return EVENT_CONT;
   }
   {
@@ -1092,7 +1235,8 @@ Lrestart:
       goto Ldone;
     }
 
-    int headerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+    int headerlen = vol->headerlen();
+    int footerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
     size_t dirlen = vol->dirlen();
     if (!writepos) {
       // start
@@ -1139,7 +1283,19 @@ Lrestart:
       vol->header->sync_serial++;
       vol->footer->sync_serial = vol->header->sync_serial;
       CHECK_DIR(d);
-      memcpy(buf, vol->raw_dir, dirlen);
+      ranges.clear();
+      if (cache_config_dir_sync_incremental && !vol->dir_sync_full) {
+        dir_sync_dirty_ranges(vol, ranges);
+        Debug("cache_dir_sync", "Dir %s: incremental sync of %zu ranges", vol->hash_text.get(), ranges.size());
+        memcpy(buf, vol->raw_dir, headerlen);
+        for (auto &r : ranges) {
+          memcpy(buf + r.first, vol->raw_dir + r.first, r.second - r.first);
+        }
+        memcpy(buf + dirlen - footerlen, vol->raw_dir + dirlen - footerlen, footerlen);
+      } else {
+        ranges.emplace_back(headerlen, dirlen - footerlen);
+        memcpy(buf, vol->raw_dir, dirlen);
+      }
       vol->dir_sync_in_progress = true;
     }
     size_t B    = vol->header->sync_serial & 1;
@@ -1149,21 +1305,25 @@ Lrestart:
       // write header
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
       writepos += headerlen;
-    } else if (writepos < static_cast<off_t>(dirlen) - headerlen) {
-      // write part of body
-      int l = SYNC_MAX_WRITE;
-      if (writepos + l > static_cast<off_t>(dirlen) - headerlen) {
-        l = dirlen - headerlen - writepos;
-      }
+    } else if (range < ranges.size()) {
+      // write part of body, an incremental sync skips the segments which did not change
+      writepos = std::max(writepos, ranges[range].first);
+      int l    = std::min<off_t>(std::max(cache_config_dir_sync_max_write, STORE_BLOCK_SIZE), ranges[range].second - writepos);
       aio_write(vol->fd, buf + writepos, l, start + writepos);
       writepos += l;
+      if (writepos >= ranges[range].second) {
+        range++;
+      }
     } else if (writepos < static_cast<off_t>(dirlen)) {
-      ink_assert(writepos == (off_t)dirlen - headerlen);
       // write footer
-      aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
-      writepos += headerlen;
+      writepos = dirlen - footerlen;
+      aio_write(vol->fd, buf + writepos, footerlen, start + writepos);
+      writepos += footerlen;
     } else {
       vol->dir_sync_in_progress = false;
+      if (vol->dir_sync_full) {
+        vol->dir_sync_full--;
+      }
       CACHE_INCREMENT_DYN_STAT(cache_directory_sync_count_stat);
       CACHE_SUM_DYN_STAT(cache_directory_sync_time_stat, Thread::get_hrtime() - start_time);
       start_time = 0;
@@ -1174,6 +1334,7 @@ Lrestart:
 Ldone:
   // done
   writepos = 0;
+  range    = 0;
   ++vol_idx;
   goto Lrestart;
 }
@@ -420,7 +420,6 @@ CacheHostTable::BuildTable(const char *config_file_path)
 int
 CacheHostRecord::Init(CacheType typ)
 {
-  int i, j;
   extern Queue<CacheVol> cp_list;
   extern int cp_list_len;
 
@@ -442,24 +441,13 @@ CacheHostRecord::Init(CacheType typ)
     RecSignalWarning(REC_SIGNAL_CONFIG_ERROR, "error: No volumes found for Cache Type %d", type);
     return -1;
   }
-  vols        = static_cast<Vol **>(ats_malloc(num_vols * sizeof(Vol *)));
-  int counter = 0;
-  for (i = 0; i < num_cachevols; i++) {
-    CacheVol *cachep1 = cp[i];
-    for (j = 0; j < cachep1->num_vols; j++) {
-      vols[counter++] = cachep1->vols[j];
-    }
-  }
-  ink_assert(counter == num_vols);
-
-  build_vol_hash_table(this);
-  return 0;
+  return build_vols();
 }
 
 int
 CacheHostRecord::Init(matcher_line *line_info, CacheType typ)
 {
-  int i, j;
+  int i;
   extern Queue<CacheVol> cp_list;
   int is_vol_present = 0;
   char config_file[PATH_NAME_MAX];
@@ -568,17 +556,50 @@ CacheHostRecord::Init(matcher_line *line_info, CacheType typ)
   if (!num_vols) {
     return -1;
   }
+  return build_vols();
+}
+
+// Collect the Vols of the CacheVols of the record. If the record has both
+// SSD and HDD volumes the SSD ones are kept apart, in ssd_tier.
+int
+CacheHostRecord::build_vols()
+{
+  int num_ssd_vols = 0;
+  for (int i = 0; i < num_cachevols; i++) {
+    if (cp[i]->tier == CACHE_TIER_SSD) {
+      num_ssd_vols += cp[i]->num_vols;
+    }
+  }
+  if (num_ssd_vols == num_vols) {
+    num_ssd_vols = 0;
+  }
+  if (num_ssd_vols) {
+    ssd_tier           = new CacheHostRecord();
+    ssd_tier->type     = type;
+    ssd_tier->num_vols = num_ssd_vols;
+    ssd_tier->vols     = static_cast<Vol **>(ats_malloc(num_ssd_vols * sizeof(Vol *)));
+    num_vols -= num_ssd_vols;
+  }
   vols        = static_cast<Vol **>(ats_malloc(num_vols * sizeof(Vol *)));
   int counter = 0;
-  for (i = 0; i < num_cachevols; i++) {
+  int nssd    = 0;
+  for (int i = 0; i < num_cachevols; i++) {
     CacheVol *cachep = cp[i];
-    for (j = 0; j < cp[i]->num_vols; j++) {
-      vols[counter++] = cachep->vols[j];
+    for (int j = 0; j < cachep->num_vols; j++) {
+      if (ssd_tier && cachep->tier == CACHE_TIER_SSD) {
+        ssd_tier->vols[nssd++] = cachep->vols[j];
+      } else {
+        vols[counter++] = cachep->vols[j];
+      }
     }
   }
-  ink_assert(counter == num_vols);
+  ink_assert(counter == num_vols && nssd == num_ssd_vols);
 
   build_vol_hash_table(this);
+  if (ssd_tier) {
+    Debug("cache_hosting", "Host Record: %p, %d HDD and %d SSD vols", this, num_vols, num_ssd_vols);
+    build_vol_hash_table(ssd_tier);
+  }
   return 0;
 }
 
@@ -659,6 +680,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
     int size              = 0;
     int in_percent        = 0;
     bool ramcache_enabled = true;
+    int tier              = CACHE_TIER_HDD;
 
     while (true) {
       // skip all blank spaces at beginning of line
@@ -758,6 +780,18 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
           err = "Unexpected end of line";
           break;
         }
+      } else if (strcasecmp(tmp, "tier") == 0) { // match tier
+        tmp += 5;
+        if (!strcasecmp(tmp, "ssd")) {
+          tmp += 3;
+          tier = CACHE_TIER_SSD;
+        } else if (!strcasecmp(tmp, "hdd")) {
+          tmp += 3;
+          tier = CACHE_TIER_HDD;
+        } else {
+          err = "Unexpected end of line";
+          break;
+        }
       }
 
       // ends here
@@ -784,6 +818,7 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       configp->size             = size;
       configp->cachep           = nullptr;
       configp->ramcache_enabled = ramcache_enabled;
+      configp->tier             = tier;
       cp_queue.enqueue(configp);
       num_volumes++;
       if (scheme == CACHE_HTTP_TYPE) {
@@ -791,8 +826,8 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         ink_release_assert(!"Unexpected non-HTTP cache volume");
       }
-      Debug("cache_hosting", "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d", volume_number, scheme, size,
-            in_percent, ramcache_enabled);
+      Debug("cache_hosting", "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d, tier=%s", volume_number, scheme,
+            size, in_percent, ramcache_enabled, tier == CACHE_TIER_SSD ? "ssd" : "hdd");
     }
 
     tmp = bufTok.iterNext(&i_state);
@@ -0,0 +1,158 @@
+/** @file
+
+  Per-thread table of hot objects, answered without the volume lock.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+#include <vector>
+
+#define HOT_OBJECT_WAYS 2 // entries a key may be stored in
+#define HOT_OBJECT_HITS_PER_ENTRY 4
+
+std::atomic<uint32_t> hot_object_epochs[HOT_OBJECT_EPOCHS];
+
+namespace
+{
+struct HotObject {
+  CacheKey key;
+  uint32_t epoch     = 0;
+  ink_hrtime expires = 0;
+  Ptr<IOBufferData> head; // the first Doc, with the alternates
+  Ptr<IOBufferData> data; // the Doc with the data, may be head
+};
+
+// A set associative table, with a counting filter of recent hits for admission.
+class HotObjectTable
+{
+public:
+  explicit HotObjectTable(int n)
+  {
+    size_t size = HOT_OBJECT_WAYS;
+    while (size < static_cast<size_t>(n)) {
+      size <<= 1;
+    }
+    _entries.resize(size);
+    _hits.resize(size * HOT_OBJECT_HITS_PER_ENTRY);
+  }
+
+  HotObject *
+  find(const CacheKey *key)
+  {
+    HotObject *set = &_entries[key->slice32(2) & (_entries.size() - HOT_OBJECT_WAYS)];
+    for (int i = 0; i < HOT_OBJECT_WAYS; i++) {
+      if (set[i].head && set[i].key == *key) {
+        return &set[i];
+      }
+    }
+    return nullptr;
+  }
+
+  // Replace the entry in the set of @a key which expires first.
+  HotObject *
+  victim(const CacheKey *key)
+  {
+    HotObject *set = &_entries[key->slice32(2) & (_entries.size() - HOT_OBJECT_WAYS)];
+    HotObject *v   = &set[0];
+    for (int i = 1; i < HOT_OBJECT_WAYS; i++) {
+      if (set[i].expires < v->expires) {
+        v = &set[i];
+      }
+    }
+    return v;
+  }
+
+  // Count a hit for @a key and return the number of recent hits.
+  int
+  count(const CacheKey *key)
+  {
+    uint8_t &h = _hits[key->slice32(3) & (_hits.size() - 1)];
+    if (h < UINT8_MAX) {
+      ++h;
+    }
+    // Halve the counts now and then so that only recent hits count.
+    if (++_samples >= _hits.size()) {
+      for (auto &x : _hits) {
+        x >>= 1;
+      }
+      _samples = 0;
+    }
+    return h;
+  }
+
+private:
+  std::vector<HotObject> _entries;
+  std::vector<uint8_t> _hits;
+  size_t _samples = 0;
+};
+
+thread_local HotObjectTable *hot_objects = nullptr;
+
+HotObjectTable *
+hot_object_table()
+{
+  if (hot_objects == nullptr && cache_config_hot_objects_entries > 0) {
+    hot_objects = new HotObjectTable(cache_config_hot_objects_entries);
+  }
+  return hot_objects;
+}
+} // namespace
+
+bool
+hot_object_get(const CacheKey *key, Ptr<IOBufferData> &head, Ptr<IOBufferData> &data)
+{
+  HotObjectTable *table = hot_object_table();
+  if (table == nullptr) {
+    return false;
+  }
+  HotObject *h = table->find(key);
+  if (h == nullptr) {
+    return false;
+  }
+  if (h->epoch != hot_object_epoch(key) || h->expires < Thread::get_hrtime()) {
+    h->head    = nullptr;
+    h->data    = nullptr;
+    h->expires = 0;
+    return false;
+  }
+  head = h->head;
+  data = h->data;
+  return true;
+}
+
+bool
+hot_object_seen(const CacheKey *key, uint32_t epoch, IOBufferData *head, IOBufferData *data)
+{
+  HotObjectTable *table = hot_object_table();
+  if (table == nullptr || table->count(key) < cache_config_hot_objects_min_hits) {
+    return false;
+  }
+  HotObject *h = table->find(key);
+  if (h == nullptr) {
+    h      = table->victim(key);
+    h->key = *key;
+  }
+  h->epoch   = epoch;
+  h->expires = Thread::get_hrtime() + HRTIME_SECONDS(cache_config_hot_objects_ttl);
+  h->head    = head;
+  h->data    = data;
+  return true;
+}
@@ -41,7 +41,9 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
   CacheVC *c        = nullptr;
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
-    if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
+    // A definite miss does not need to wait for the lock.
+    if (lock.is_locked() ? (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision) :
+                           !dir_probe_miss(key, vol)) {
       c = new_CacheVC(cont);
       SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
       c->vio.op    = VIO::READ;
@@ -100,15 +102,42 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
   }
   ink_assert(caches[type] == this);
 
-  Vol *vol = key_to_vol(key, hostname, host_len);
+  uint32_t tier_epoch = cache_tier_epoch(key);
+  Vol *other_tier     = nullptr;
+  Vol *vol            = key_to_vol(key, hostname, host_len, &other_tier);
   Dir result, *last_collision = nullptr;
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
   CacheVC *c        = nullptr;
+  uint32_t epoch    = hot_object_epoch(key);
+  Ptr<IOBufferData> hot_head, hot_data;
+
+  if (hot_object_get(key, hot_head, hot_data)) {
+    c            = new_CacheVC(cont);
+    c->first_key = c->key = c->earliest_key = *key;
+    c->vol                                  = vol;
+    c->vio.op                               = VIO::READ;
+    c->base_stat                            = cache_read_active_stat;
+    CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+    c->request.copy_shallow(request);
+    c->frag_type            = CACHE_FRAG_TYPE_HTTP;
+    c->params               = params;
+    c->first_buf            = hot_head;
+    c->buf                  = hot_data;
+    c->f.hot_object         = 1;
+    c->f.doc_from_ram_cache = 1;
+    SET_CONTINUATION_HANDLER(c, &CacheVC::openReadHotObject);
+    if (c->handleEvent(EVENT_IMMEDIATE, nullptr) == EVENT_DONE) {
+      return ACTION_RESULT_DONE;
+    }
+    return &c->_action;
+  }
 
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
-    if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
+    // A definite miss does not need to wait for the lock.
+    if (lock.is_locked() ? (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision) :
+                           !dir_probe_miss(key, vol)) {
       c            = new_CacheVC(cont);
       c->first_key = c->key = c->earliest_key = *key;
       c->vol                                  = vol;
@@ -116,18 +145,25 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
       c->base_stat                            = cache_read_active_stat;
       CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
       c->request.copy_shallow(request);
-      c->frag_type = CACHE_FRAG_TYPE_HTTP;
-      c->params    = params;
-      c->od        = od;
+      c->frag_type       = CACHE_FRAG_TYPE_HTTP;
+      c->params          = params;
+      c->od              = od;
+      c->hot_epoch       = epoch;
+      c->f.hot_candidate = 1;
+      // promote the document if it is read often from the HDD tier
+      if (other_tier && vol->cache_vol->tier == CACHE_TIER_HDD && cache_tier_hit(key)) {
+        c->tier_vol   = other_tier;
+        c->tier_epoch = tier_epoch;
+      }
+    }
+    if (!c) {
+      goto Lmiss;
     }
     if (!lock.is_locked()) {
       SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
       CONT_SCHED_LOCK_RETRY(c);
       return &c->_action;
     }
-    if (!c) {
-      goto Lmiss;
-    }
     if (c->od) {
       goto Lwriter;
     }
@@ -531,6 +567,9 @@ CacheVC::openReadClose(int event, Event * /* e ATS_UNUSED */)
     }
     set_io_not_in_progress();
   }
+  if (f.hot_object) { // never registered with the volume
+    return free_CacheVC(this);
+  }
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     VC_SCHED_LOCK_RETRY();
@@ -908,6 +947,14 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
     doc_pos      = doc->prefix_len();
     next_CacheKey(&key, &doc->key);
     vol->begin_read(this);
+    if (f.hot_candidate && first_buf && vector.count() == 1 && doc->single_fragment() &&
+        doc->len + reinterpret_cast<Doc *>(first_buf->data())->len <= static_cast<uint32_t>(cache_config_hot_objects_max_size) &&
+        hot_object_seen(&first_key, hot_epoch, first_buf.get(), buf.get())) {
+      CACHE_INCREMENT_DYN_STAT(cache_hot_object_inserts_stat);
+    }
+    if (tier_vol && vector.count() == 1 && doc->single_fragment() && doc_len <= static_cast<uint64_t>(cache_config_tier_max_size)) {
+      cache_tier_move(vol, tier_vol, &first_key, &first_dir, tier_epoch, hot_epoch);
+    }
     if (vol->within_hit_evacuate_window(&earliest_dir) &&
         (!cache_config_hit_evacuate_size_limit || doc_len <= static_cast<uint64_t>(cache_config_hit_evacuate_size_limit))) {
       DDebug("cache_hit_evac", "dir: %" PRId64 ", write: %" PRId64 ", phase: %d", dir_offset(&earliest_dir),
@@ -1049,6 +1096,36 @@ Lrestart:
   return openReadStartHead(EVENT_IMMEDIATE, nullptr);
 }
 
+// Serve a document from the hot objects of this thread, without the volume.
+// This follows the successful paths of CacheVC::openReadStartHead and
+// CacheVC::openReadStartEarliest.
+int
+CacheVC::openReadHotObject(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  Doc *doc = reinterpret_cast<Doc *>(first_buf->data());
+
+  this->load_http_info(&vector, doc);
+  alternate_index = cache_config_select_alternate ? HttpTransactCache::SelectFromAlternates(&vector, &request, params) : 0;
+  if (alternate_index >= 0) {
+    alternate.copy_shallow(vector.get(alternate_index));
+    alternate.object_key_get(&key);
+    doc = reinterpret_cast<Doc *>(buf->data());
+  }
+  if (alternate_index < 0 || !(doc->key == key)) {
+    CACHE_INCREMENT_DYN_STAT(cache_read_failure_stat);
+    _action.continuation->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_ALT_MISS);
+    return free_CacheVC(this);
+  }
+  earliest_key      = key;
+  doc_len           = alternate.object_size_get();
+  f.single_fragment = buf == first_buf;
+  doc_pos           = doc->prefix_len();
+  next_CacheKey(&key, &doc->key);
+  CACHE_INCREMENT_DYN_STAT(cache_hot_object_hits_stat);
+  SET_HANDLER(&CacheVC::openReadMain);
+  return callcont(CACHE_EVENT_OPEN_READ);
+}
+
 /*
   This code follows CacheVC::openReadStartEarliest closely,
   if you change this you might have to change that.
@@ -1202,6 +1279,15 @@ CacheVC::openReadStartHead(int event, Event *e)
     first_buf = buf;
     vol->begin_read(this);
 
+    if (f.hot_candidate && vector.count() == 1 && doc->single_fragment() &&
+        doc->len <= static_cast<uint32_t>(cache_config_hot_objects_max_size) &&
+        hot_object_seen(&first_key, hot_epoch, buf.get(), buf.get())) {
+      CACHE_INCREMENT_DYN_STAT(cache_hot_object_inserts_stat);
+    }
+    if (tier_vol && vector.count() == 1 && doc_len <= static_cast<uint64_t>(cache_config_tier_max_size)) {
+      cache_tier_move(vol, tier_vol, &first_key, &first_dir, tier_epoch, hot_epoch);
+    }
+
     goto Lsuccess;
 
   Lread:
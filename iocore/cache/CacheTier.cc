@@ -0,0 +1,423 @@
+/** @file
+
+  Moves documents between the SSD and the HDD tier of a host record.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Cache.h"
+
+#define CACHE_TIER_HITS (1 << 16) // counters of recent reads from the HDD tier
+#define CACHE_TIER_RETRY_DELAY HRTIME_MSECONDS(cache_config_mutex_retry_delay)
+
+std::atomic<uint32_t> cache_tier_epochs[CACHE_TIER_EPOCHS];
+
+namespace
+{
+std::atomic<uint8_t> tier_hits[CACHE_TIER_HITS];
+std::atomic<uint32_t> tier_hit_samples;
+std::atomic<int> tier_moves;
+
+// Returns the directory entry for @a key in @a vol at the same offset as @a d, if any.
+bool
+dir_find_exact(const CacheKey *key, Vol *vol, const Dir *d)
+{
+  Dir e;
+  Dir *last_collision = nullptr;
+  while (dir_probe(key, vol, &e, &last_collision)) {
+    if (dir_offset(&e) == dir_offset(d)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Deletes all the directory entries for @a key in @a vol.
+void
+dir_delete_all(const CacheKey *key, Vol *vol)
+{
+  Dir e;
+  Dir *last_collision = nullptr;
+  while (dir_probe(key, vol, &e, &last_collision) && dir_delete(key, vol, &e)) {
+    last_collision = nullptr;
+  }
+}
+} // namespace
+
+/*
+  Reads the head Doc and the data Doc of a document from one volume and writes
+  them through the aggregation buffer of the other, then moves the directory
+  entries. The head is known up front for a promotion; for a demotion the key
+  and the target volume are taken from the head Doc.
+*/
+struct CacheTierMove : public Continuation {
+  Vol *from = nullptr;
+  Vol *to   = nullptr;
+  CacheKey key;
+  CacheKey earliest_key;
+  Dir head_dir;
+  Dir data_dir;
+  Dir new_head_dir;
+  Dir new_data_dir;
+  uint32_t tier_epoch = 0;
+  uint32_t epoch      = 0;
+  int writes          = 0; // Docs still in the aggregation buffer of the target
+  Ptr<IOBufferData> head_buf;
+  Ptr<IOBufferData> data_buf; // not set if the data is in the head Doc
+  AIOCallbackInternal io;
+
+  int readHead(int event, Event *e);
+  int readHeadDone(int event, Event *e);
+  int readData(int event, Event *e);
+  int readDataDone(int event, Event *e);
+  int writeDocs(int event, Event *e);
+  int commit(int event, Event *e);
+
+  int read(Dir *d, Ptr<IOBufferData> &b, ContinuationHandler next);
+  int done(bool moved);
+
+  CacheTierMove(Vol *f, Vol *t) : Continuation(new_ProxyMutex()), from(f), to(t) { SET_HANDLER(&CacheTierMove::readHead); }
+};
+
+bool
+cache_tier_hit(const CacheKey *key)
+{
+  if (cache_config_tier_promote_hits <= 0) {
+    return false;
+  }
+  std::atomic<uint8_t> &h = tier_hits[key->slice32(3) & (CACHE_TIER_HITS - 1)];
+  uint8_t n               = h.load(std::memory_order_relaxed);
+  if (n < UINT8_MAX) {
+    h.store(++n, std::memory_order_relaxed);
+  }
+  // Halve the counts now and then so that only recent reads count.
+  if (tier_hit_samples.fetch_add(1, std::memory_order_relaxed) + 1 == CACHE_TIER_HITS) {
+    for (auto &x : tier_hits) {
+      x.store(x.load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+    }
+    tier_hit_samples = 0;
+  }
+  return n >= cache_config_tier_promote_hits;
+}
+
+static CacheTierMove *
+new_CacheTierMove(Vol *from, Vol *to)
+{
+  if (tier_moves.fetch_add(1) >= CACHE_TIER_MAX_MOVES) {
+    tier_moves.fetch_sub(1);
+    return nullptr;
+  }
+  return new CacheTierMove(from, to);
+}
+
+void
+cache_tier_move(Vol *from, Vol *to, const CacheKey *key, const Dir *head, uint32_t tier_epoch, uint32_t epoch)
+{
+  CacheTierMove *m = new_CacheTierMove(from, to);
+  if (m == nullptr) {
+    return;
+  }
+  m->key        = *key;
+  m->head_dir   = *head;
+  m->tier_epoch = tier_epoch;
+  m->epoch      = epoch;
+  eventProcessor.schedule_imm(m, ET_CALL);
+}
+
+// Reads the Doc at @a d of the source volume into @a b and continues with @a next.
+int
+CacheTierMove::read(Dir *d, Ptr<IOBufferData> &b, ContinuationHandler next)
+{
+  CACHE_TRY_LOCK(lock, from->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    mutex->thread_holding->schedule_in(this, CACHE_TIER_RETRY_DELAY);
+    return EVENT_CONT;
+  }
+  io.aiocb.aio_nbytes = dir_approx_size(d);
+  b                   = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  handler             = next;
+  if (dir_agg_buf_valid(from, d)) {
+    memcpy(b->data(), from->agg_buffer + from->vol_offset(d) - from->header->write_pos, io.aiocb.aio_nbytes);
+    io.aio_result = io.aiocb.aio_nbytes;
+    MUTEX_RELEASE(lock);
+    return handleEvent(AIO_EVENT_DONE, nullptr);
+  }
+  // the Doc may be overwritten by the aggregation write in progress
+  if (!dir_agg_valid(from, d)) {
+    return this->done(false);
+  }
+  io.aiocb.aio_fildes = from->fd;
+  io.aiocb.aio_offset = from->vol_offset(d);
+  if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(from->skip + from->len)) {
+    io.aiocb.aio_nbytes = from->skip + from->len - io.aiocb.aio_offset;
+  }
+  io.aiocb.aio_buf = b->data();
+  io.action        = this;
+  io.thread        = AIO_CALLBACK_THREAD_ANY;
+  ink_assert(ink_aio_read(&io) >= 0);
+  return EVENT_CONT;
+}
+
+int
+CacheTierMove::readHead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  return read(&head_dir, head_buf, reinterpret_cast<ContinuationHandler>(&CacheTierMove::readHeadDone));
+}
+
+int
+CacheTierMove::readHeadDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  Doc *doc = reinterpret_cast<Doc *>(head_buf->data());
+  CacheHTTPInfoVector vector;
+  CacheHTTPInfo *alt;
+
+  if (!io.ok() || doc->magic != DOC_MAGIC || doc->doc_type != CACHE_FRAG_TYPE_HTTP || !doc->hlen ||
+      !dir_compare_tag(&head_dir, &doc->first_key) || doc->len > io.aiocb.aio_nbytes) {
+    return done(false);
+  }
+  if (to == nullptr) { // demotion
+    key        = doc->first_key;
+    tier_epoch = cache_tier_epoch(&key);
+    epoch      = hot_object_epoch(&key);
+  } else if (!(doc->first_key == key)) {
+    return done(false);
+  }
+
+  // Unmarshal a copy of the alternates, the head Doc is written as it was read.
+  Ptr<IOBufferData> hdr = make_ptr(new_IOBufferData(iobuffer_size_to_index(doc->hlen, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+  memcpy(hdr->data(), doc->hdr(), doc->hlen);
+  if (vector.unmarshal(hdr->data(), doc->hlen, hdr.get()) != static_cast<int>(doc->hlen) || vector.count() != 1 ||
+      !(alt = vector.get(0))->valid() || alt->object_size_get() > cache_config_tier_max_size) {
+    vector.clear();
+    return done(false);
+  }
+  alt->object_key_get(&earliest_key);
+  if (to == nullptr) {
+    int host_len;
+    const char *host = alt->request_get()->host_get(&host_len);
+    to               = caches[CACHE_FRAG_TYPE_HTTP]->key_to_tier_vol(&key, host, host ? host_len : 0, CACHE_TIER_HDD);
+  }
+  vector.clear();
+
+  if (to == nullptr || to == from) {
+    return done(false);
+  }
+  if (earliest_key == doc->key) {
+    if (!doc->single_fragment()) {
+      return done(false);
+    }
+    SET_HANDLER(&CacheTierMove::writeDocs);
+    return writeDocs(EVENT_IMMEDIATE, nullptr);
+  }
+  SET_HANDLER(&CacheTierMove::readData);
+  return readData(EVENT_IMMEDIATE, nullptr);
+}
+
+int
+CacheTierMove::readData(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  {
+    CACHE_TRY_LOCK(lock, from->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      mutex->thread_holding->schedule_in(this, CACHE_TIER_RETRY_DELAY);
+      return EVENT_CONT;
+    }
+    Dir *last_collision = nullptr;
+    if (!dir_probe(&earliest_key, from, &data_dir, &last_collision)) {
+      return done(false);
+    }
+  }
+  return read(&data_dir, data_buf, reinterpret_cast<ContinuationHandler>(&CacheTierMove::readDataDone));
+}
+
+int
+CacheTierMove::readDataDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  Doc *doc = reinterpret_cast<Doc *>(data_buf->data());
+
+  if (!io.ok() || doc->magic != DOC_MAGIC || !(doc->key == earliest_key) || !(doc->first_key == key) || !doc->single_fragment() ||
+      doc->len > io.aiocb.aio_nbytes) {
+    return done(false);
+  }
+  SET_HANDLER(&CacheTierMove::writeDocs);
+  return writeDocs(EVENT_IMMEDIATE, nullptr);
+}
+
+// Writes the Docs like an evacuation of the target volume, data first.
+int
+CacheTierMove::writeDocs(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  CACHE_TRY_LOCK(lock, to->mutex, mutex->thread_holding);
+  if (!lock.is_locked()) {
+    mutex->thread_holding->schedule_in(this, CACHE_TIER_RETRY_DELAY);
+    return EVENT_CONT;
+  }
+  if (to->agg_todo_size > cache_config_agg_write_backlog ||
+      to->round_to_approx_size(reinterpret_cast<Doc *>(head_buf->data())->len) > AGG_SIZE ||
+      (data_buf && to->round_to_approx_size(reinterpret_cast<Doc *>(data_buf->data())->len) > AGG_SIZE)) {
+    return done(false);
+  }
+  SET_HANDLER(&CacheTierMove::commit);
+  writes = data_buf ? 2 : 1;
+  for (IOBufferData *b : {data_buf.get(), head_buf.get()}) {
+    if (b == nullptr) {
+      continue;
+    }
+    Doc *doc         = reinterpret_cast<Doc *>(b->data());
+    CacheVC *c       = new_DocEvacuator(doc->len, to);
+    c->_action       = this;
+    c->overwrite_dir = b == head_buf.get() ? head_dir : data_dir;
+    c->first_key     = doc->first_key;
+    c->key           = doc->key;
+    memcpy(c->buf->data(), doc, doc->len);
+    SET_CONTINUATION_HANDLER(c, &CacheVC::tierMoveDocDone);
+    to->evacuateWrite(c, EVENT_IMMEDIATE, nullptr);
+  }
+  return EVENT_CONT;
+}
+
+// Called with the lock of the target volume when a Doc is in its aggregation buffer.
+int
+CacheVC::tierMoveDocDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  CacheTierMove *m = static_cast<CacheTierMove *>(_action.continuation);
+  if (m->data_buf && key == m->earliest_key) {
+    m->new_data_dir = dir;
+  } else {
+    m->new_head_dir = dir;
+  }
+  if (--m->writes == 0) {
+    eventProcessor.schedule_imm(m, ET_CALL);
+  }
+  return free_CacheVC(this);
+}
+
+int
+CacheTierMove::commit(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  CACHE_TRY_LOCK(from_lock, from->mutex, mutex->thread_holding);
+  CACHE_TRY_LOCK(to_lock, to->mutex, mutex->thread_holding);
+  if (!from_lock.is_locked() || !to_lock.is_locked()) {
+    mutex->thread_holding->schedule_in(this, CACHE_TIER_RETRY_DELAY);
+    return EVENT_CONT;
+  }
+  // Give up if the document changed or was moved, the written Docs are just dropped.
+  if (cache_tier_epoch(&key) != tier_epoch || hot_object_epoch(&key) != epoch || from->open_read(&key) || to->open_read(&key) ||
+      !dir_valid(from, &head_dir) || !dir_find_exact(&key, from, &head_dir) || (data_buf && !dir_valid(from, &data_dir))) {
+    return done(false);
+  }
+  dir_delete_all(&key, to);
+  if (data_buf) {
+    dir_insert(&earliest_key, to, &new_data_dir);
+  }
+  dir_insert(&key, to, &new_head_dir);
+  dir_delete(&key, from, &head_dir);
+  if (data_buf) {
+    dir_delete(&earliest_key, from, &data_dir);
+  }
+  cache_tier_epochs[key.slice32(1) & (CACHE_TIER_EPOCHS - 1)].fetch_add(1, std::memory_order_acq_rel);
+  return done(true);
+}
+
+int
+CacheTierMove::done(bool moved)
+{
+  Vol *vol = to ? to : from;
+  if (!moved) {
+    CACHE_INCREMENT_DYN_STAT(cache_tier_move_failures_stat);
+  } else if (vol->cache_vol->tier == CACHE_TIER_SSD) {
+    CACHE_INCREMENT_DYN_STAT(cache_tier_promotions_stat);
+  } else {
+    CACHE_INCREMENT_DYN_STAT(cache_tier_demotions_stat);
+  }
+  Debug("cache_tier", "%s %X from %s to %s", moved ? "moved" : "failed to move", key.slice32(0), from->hash_text.get(),
+        to ? to->hash_text.get() : "-");
+  delete this;
+  tier_moves.fetch_sub(1);
+  return EVENT_DONE;
+}
+
+/*
+  Demote the documents in the region the write position of an SSD volume is
+  about to overwrite, the region scan_for_pinned_documents evacuates pinned
+  documents from.
+*/
+void
+Vol::scan_for_demotion()
+{
+  int ps                = this->offset_to_vol_offset(header->write_pos + AGG_SIZE);
+  int pe                = this->offset_to_vol_offset(header->write_pos + 2 * EVACUATION_SIZE + (len / PIN_SCAN_EVERY));
+  int vol_end_offset    = this->offset_to_vol_offset(len + skip);
+  int before_end_of_vol = pe < vol_end_offset;
+  for (int i = 0; i < this->direntries() && tier_moves < CACHE_TIER_MAX_MOVES; i++) {
+    if (dir_is_empty(&dir[i]) || !dir_head(&dir[i]) || dir_pinned(&dir[i])) {
+      continue;
+    }
+    int o = dir_offset(&dir[i]);
+    if (dir_phase(&dir[i]) == header->phase) {
+      if (before_end_of_vol || o >= (pe - vol_end_offset)) {
+        continue;
+      }
+    } else {
+      if (o < ps || o >= pe) {
+        continue;
+      }
+    }
+    CacheTierMove *m = new_CacheTierMove(this, nullptr);
+    if (m == nullptr) {
+      break;
+    }
+    m->head_dir = dir[i];
+    eventProcessor.schedule_imm(m, ET_CALL);
+  }
+}
+
+/*
+  Removes the entries for a key left in the HDD tier when a writer replaces a
+  document which is in the SSD tier.
+*/
+struct CacheTierForget : public Continuation {
+  Vol *vol;
+  CacheKey key;
+
+  int
+  forget(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      mutex->thread_holding->schedule_in(this, CACHE_TIER_RETRY_DELAY);
+      return EVENT_CONT;
+    }
+    dir_delete_all(&key, vol);
+    MUTEX_RELEASE(lock);
+    delete this;
+    return EVENT_DONE;
+  }
+
+  CacheTierForget(Vol *v, const CacheKey *k) : Continuation(new_ProxyMutex()), vol(v), key(*k)
+  {
+    SET_HANDLER(&CacheTierForget::forget);
+  }
+};
+
+void
+cache_tier_forget(Vol *vol, const CacheKey *key)
+{
+  eventProcessor.schedule_imm(new CacheTierForget(vol, key), ET_CALL);
+}
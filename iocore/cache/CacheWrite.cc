@@ -23,6 +23,8 @@
 
 #include "P_Cache.h"
 
+#include <algorithm>
+
 #define UINT_WRAP_LTE(_x, _y) (((_y) - (_x)) < INT_MAX) // exploit overflow
 #define UINT_WRAP_GTE(_x, _y) (((_x) - (_y)) < INT_MAX) // exploit overflow
 #define UINT_WRAP_LT(_x, _y) (((_x) - (_y)) >= INT_MAX) // exploit overflow
@@ -206,6 +208,10 @@ CacheVC::handleWrite(int event, Event * /* e ATS_UNUSED */)
     CACHE_INCREMENT_DYN_STAT(base_stat + CACHE_STAT_FAILURE);
     vol->agg_todo_size -= agg_len;
     io.aio_result = AIO_SOFT_FAILURE;
+    if (direct_buf) {
+      ats_memalign_free(direct_buf);
+      direct_buf = nullptr;
+    }
     if (event == EVENT_CALL) {
       return EVENT_RETURN;
     }
@@ -250,6 +256,23 @@ iobufferblock_memcpy(char *p, int len, IOBufferBlock *ab, int offset)
   return p;
 }
 
+// Large fragments are copied into a buffer of their own before the volume lock is
+// taken. Vol::aggWrite only fills in the Doc header and writes the buffer by itself.
+void
+CacheVC::direct_write_prepare()
+{
+  if (direct_buf || !cache_config_agg_write_direct_size || !write_len || f.rewrite_resident_alt) {
+    return;
+  }
+  uint32_t len = vol->round_to_approx_size(write_len + header_len + sizeof(Doc));
+  if (len < static_cast<uint32_t>(cache_config_agg_write_direct_size) || len > AGG_SIZE) {
+    return;
+  }
+  direct_buf = static_cast<char *>(ats_memalign(ats_pagesize(), len));
+  char *p    = iobufferblock_memcpy(direct_buf + sizeof(Doc) + header_len, write_len, blocks.get(), offset);
+  memset(p, 0, direct_buf + len - p);
+}
+
 EvacuationBlock *
 Vol::force_evacuate_head(Dir *evac_dir, int pinned)
 {
@@ -355,6 +378,10 @@ Vol::aggWriteDone(int event, Event *e)
     }
     agg_buf_pos = 0;
   }
+  if (agg_buffer != agg_main_buffer) {
+    ats_memalign_free(agg_buffer);
+    agg_buffer = agg_main_buffer;
+  }
   set_io_not_in_progress();
   // callback ready sync CacheVCs
   CacheVC *c = nullptr;
@@ -836,7 +863,10 @@ agg_copy(char *p, CacheVC *vc)
         ink_assert(mutex->thread_holding == this_ethread());
         CACHE_DEBUG_SUM_DYN_STAT(cache_write_bytes_stat, vc->write_len);
       }
-      if (vc->f.rewrite_resident_alt) {
+      if (vc->direct_buf) {
+        // the data is already in place
+        ink_assert(p == vc->direct_buf);
+      } else if (vc->f.rewrite_resident_alt) {
         iobufferblock_memcpy(doc->data(), vc->write_len, res_alt_blk, 0);
       } else {
         iobufferblock_memcpy(doc->data(), vc->write_len, vc->blocks.get(), vc->offset);
@@ -945,6 +975,9 @@ Vol::periodic_scan()
 {
   evacuate_cleanup();
   scan_for_pinned_documents();
+  if (cache_vol->tier == CACHE_TIER_SSD && cache_config_tier_demote) {
+    scan_for_demotion();
+  }
   if (header->write_pos == start) {
     scan_pos = start;
   }
@@ -992,12 +1025,28 @@ Lagain:
     int writelen = c->agg_len;
     // [amc] this is checked multiple places, on here was it strictly less.
     ink_assert(writelen <= AGG_SIZE);
+    if (agg_buffer != agg_main_buffer) { // a large fragment is waiting to be written
+      break;
+    }
     if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
       break;
     }
+    if (c->direct_buf) {
+      // write out what was aggregated before, then the fragment from its own buffer
+      if (agg_buf_pos) {
+        break;
+      }
+      agg_buffer = c->direct_buf;
+      Vol *vol   = this; // for the STAT macros
+      CACHE_INCREMENT_DYN_STAT(cache_agg_write_direct_stat);
+      CACHE_SUM_DYN_STAT(cache_agg_write_direct_bytes_stat, writelen);
+    } else if (!agg_buf_pos) {
+      agg_fill_start = Thread::get_hrtime();
+    }
     DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos, c->first_key.slice32(0));
     int wrotelen = agg_copy(agg_buffer + agg_buf_pos, c);
     ink_assert(writelen == wrotelen);
+    c->direct_buf = nullptr;
     agg_todo_size -= writelen;
     agg_buf_pos += writelen;
     CacheVC *n = (CacheVC *)c->link.next;
@@ -1052,10 +1101,18 @@ Lagain:
 
   // if agg.head, then we are near the end of the disk, so
   // write down the aggregation in whatever size it is.
-  if (agg_buf_pos < AGG_HIGH_WATER && !agg.head && !sync.head && !dir_sync_waiting) {
+  if (agg_buffer == agg_main_buffer && agg_buf_pos < agg_high_water && !agg.head && !sync.head && !dir_sync_waiting) {
     goto Lwait;
   }
 
+  // aim for a write every fill_time at the rate the buffer was filled
+  if (cache_config_agg_write_fill_time && agg_buffer == agg_main_buffer && agg_buf_pos) {
+    ink_hrtime fill = Thread::get_hrtime() - agg_fill_start;
+    int64_t size    = fill > 0 ? agg_buf_pos * HRTIME_MSECONDS(cache_config_agg_write_fill_time) / fill : AGG_SIZE;
+    size            = std::clamp(size, static_cast<int64_t>(AGG_LOW_WATER), static_cast<int64_t>(AGG_SIZE));
+    agg_high_water  = (3 * static_cast<int64_t>(agg_high_water) + size) / 4;
+  }
+
   // write sync marker
   if (!agg_buf_pos) {
     ink_assert(sync.head);
@@ -1638,6 +1695,19 @@ CacheVC::openWriteStartBegin(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED
   }
 }
 
+// Chooses the volume for a writer of @a key, new documents go to the SSD tier
+// if proxy.config.cache.tier.admit is set.
+static Vol *
+write_vol(Cache *cache, CacheVC *c, const CacheKey *key, const char *hostname, int host_len)
+{
+  c->tier_epoch = cache_tier_epoch(key);
+  Vol *vol      = cache->key_to_vol(key, hostname, host_len, &c->tier_vol);
+  if (cache_config_tier_admit && c->tier_vol && vol->cache_vol->tier == CACHE_TIER_HDD && dir_probe_miss(key, vol)) {
+    std::swap(vol, c->tier_vol);
+  }
+  return vol;
+}
+
 // main entry point for writing of of non-http documents
 Action *
 Cache::open_write(Continuation *cont, const CacheKey *key, CacheFragType frag_type, int options, time_t apin_in_cache,
@@ -1656,7 +1726,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheFragType frag_ty
   SCOPED_MUTEX_LOCK(lock, c->mutex, this_ethread());
   c->vio.op    = VIO::WRITE;
   c->base_stat = cache_write_active_stat;
-  c->vol       = key_to_vol(key, hostname, host_len);
+  c->vol       = write_vol(this, c, key, hostname, host_len);
   Vol *vol     = c->vol;
   CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
   c->first_key = c->key = *key;
@@ -1733,7 +1803,7 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info,
   } while (DIR_MASK_TAG(c->key.slice32(2)) == DIR_MASK_TAG(c->first_key.slice32(2)));
   c->earliest_key = c->key;
   c->frag_type    = CACHE_FRAG_TYPE_HTTP;
-  c->vol          = key_to_vol(key, hostname, host_len);
+  c->vol          = write_vol(this, c, key, hostname, host_len);
   Vol *vol        = c->vol;
   c->info         = info;
   if (c->info && (uintptr_t)info != CACHE_ALLOW_MULTIPLE_WRITES) {
@@ -23,6 +23,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 #include "P_CacheHttp.h"
 
 struct Vol;
@@ -52,8 +56,6 @@ struct CacheVC;
 #define DIR_OFFSET_BITS 40
 #define DIR_OFFSET_MAX ((((off_t)1) << DIR_OFFSET_BITS) - 1)
 
-#define SYNC_MAX_WRITE (2 * 1024 * 1024)
-#define SYNC_DELAY HRTIME_MSECONDS(500)
 #define DO_NOT_REMOVE_THIS 0
 
 // Debugging Options
@@ -257,12 +259,38 @@ struct OpenDir : public Continuation {
   OpenDir();
 };
 
+// Per segment state which can be read without the Vol mutex.
+//
+// Directory writers hold the Vol mutex and keep the sequence number odd while they modify
+// the segment (see DirSegmentWriter), so a reader can validate an unlocked scan of the
+// segment by checking that the sequence number is even and unchanged afterwards.
+struct DirSegmentSeq {
+  std::atomic<uint32_t> seq{0};
+  std::atomic<uint32_t> writers{0}; // open directory entries whose first key is in this segment
+  uint32_t sync_serial = 0;          // header sync serial of the last change, under the Vol mutex
+};
+
+// Marks a segment, or all segments if @a s is negative, as being modified while in scope.
+// The Vol mutex must be held. A writer nested inside another one for the same segment does
+// nothing, the outermost writer publishes the change and records it for the next dir sync.
+struct DirSegmentWriter {
+  DirSegmentWriter(Vol *d, int s);
+  ~DirSegmentWriter();
+
+  Vol *vol;
+  int segment;
+  bool owner = false;
+};
+
 struct CacheSync : public Continuation {
   int vol_idx    = 0;
   char *buf      = nullptr;
   size_t buflen  = 0;
   bool buf_huge  = false;
   off_t writepos = 0;
+  // Body ranges of the directory copy being written, every segment unless the sync is incremental.
+  std::vector<std::pair<off_t, off_t>> ranges;
+  size_t range = 0;
   AIOCallbackInternal io;
   Event *trigger        = nullptr;
   ink_hrtime start_time = 0;
@@ -277,6 +305,7 @@ struct CacheSync : public Continuation {
 void vol_init_dir(Vol *d);
 int dir_token_probe(const CacheKey *, Vol *, Dir *);
 int dir_probe(const CacheKey *, Vol *, Dir *, Dir **);
+bool dir_probe_miss(const CacheKey *key, Vol *d);
 int dir_insert(const CacheKey *key, Vol *d, Dir *to_part);
 int dir_overwrite(const CacheKey *key, Vol *d, Dir *to_part, Dir *overwrite, bool must_overwrite = true);
 int dir_delete(const CacheKey *key, Vol *d, Dir *del);
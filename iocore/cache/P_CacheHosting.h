@@ -46,6 +46,7 @@ struct CacheHostRecord {
     ats_free(vols);
     ats_free(vol_hash_table);
     ats_free(cp);
+    delete ssd_tier;
   }
 
   CacheType type                 = CACHE_NONE_TYPE;
@@ -56,8 +57,14 @@ struct CacheHostRecord {
   unsigned short *vol_hash_table = nullptr;
   CacheVol **cp                  = nullptr;
   int num_cachevols              = 0;
+  // The SSD volumes of the record, if it also has HDD volumes. Objects are
+  // looked up in this tier first and are moved between the tiers.
+  CacheHostRecord *ssd_tier = nullptr;
 
   CacheHostRecord() {}
+
+private:
+  int build_vols();
 };
 
 void build_vol_hash_table(CacheHostRecord *cp);
@@ -177,6 +184,7 @@ struct ConfigVol {
   off_t size;
   bool in_percent;
   bool ramcache_enabled;
+  int tier;
   int percent;
   CacheVol *cachep;
   LINK(ConfigVol, link);
@@ -0,0 +1,68 @@
+/** @file
+
+  Per-thread table of hot objects, answered without the volume lock.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "I_Cache.h"
+
+/*
+  Small HTTP documents which are read often are kept, fully unmarshalled, in a
+  table private to each event thread so that a hit can be answered by
+  Cache::open_read without the directory or the volume lock. A document is
+  kept if it has a single alternate whose data is in one fragment, either in
+  the first Doc with the header or in the Doc following it.
+
+  Each thread only ever touches its own table. The document buffers are
+  shared, read only, with the RAM cache and other threads. A table entry is
+  valid while the invalidation epoch of its key is unchanged; the epoch is
+  bumped whenever a writer or a remove opens or closes the key.
+*/
+
+#define HOT_OBJECT_EPOCHS (1 << 16) // invalidation epochs, shared by keys with the same hash
+
+extern std::atomic<uint32_t> hot_object_epochs[HOT_OBJECT_EPOCHS];
+
+extern int cache_config_hot_objects_entries;
+extern int cache_config_hot_objects_max_size;
+extern int cache_config_hot_objects_min_hits;
+extern int cache_config_hot_objects_ttl;
+
+inline uint32_t
+hot_object_epoch(const CacheKey *key)
+{
+  return hot_object_epochs[key->slice32(1) & (HOT_OBJECT_EPOCHS - 1)].load(std::memory_order_acquire);
+}
+
+// Invalidate any hot copies of the object for @a key on all threads.
+inline void
+hot_object_invalidate(const CacheKey *key)
+{
+  hot_object_epochs[key->slice32(1) & (HOT_OBJECT_EPOCHS - 1)].fetch_add(1, std::memory_order_acq_rel);
+}
+
+// Returns the Docs with the header and the data of the document for @a key from the table of this thread.
+bool hot_object_get(const CacheKey *key, Ptr<IOBufferData> &head, Ptr<IOBufferData> &data);
+// Counts a hit for the document for @a key read at @a epoch, and returns true if it was added to the table.
+bool hot_object_seen(const CacheKey *key, uint32_t epoch, IOBufferData *head, IOBufferData *data);
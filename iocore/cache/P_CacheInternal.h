@@ -105,6 +105,15 @@ enum {
   cache_direntries_used_stat,
   cache_ram_cache_hits_stat,
   cache_ram_cache_misses_stat,
+  cache_ram_cache_zero_copy_stat,
+  cache_ram_cache_compress_skipped_stat,
+  cache_hot_object_hits_stat,
+  cache_hot_object_inserts_stat,
+  cache_tier_promotions_stat,
+  cache_tier_demotions_stat,
+  cache_tier_move_failures_stat,
+  cache_agg_write_direct_stat,
+  cache_agg_write_direct_bytes_stat,
   cache_pread_count_stat,
   cache_percent_full_stat,
   cache_lookup_active_stat,
@@ -145,6 +154,9 @@ enum {
   cache_directory_sync_count_stat,
   cache_directory_sync_time_stat,
   cache_directory_sync_bytes_stat,
+  cache_directory_load_pending_stat,
+  cache_directory_load_bytes_stat,
+  cache_directory_recover_bytes_stat,
   /* AIO read/write error counters */
   cache_span_errors_read_stat,
   cache_span_errors_write_stat,
@@ -193,8 +205,11 @@ extern RecRawStatBlock *cache_rsb;
 
 #define GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(x, y) RecIncrGlobalRawStatSum(cache_rsb, (x), (y))
 
-#define CACHE_SUM_GLOBAL_DYN_STAT(x, y) \
-  RecIncrGlobalRawStatSum(cache_rsb, (x), (y)) RecIncrGlobalRawStatSum(vol->cache_vol->vol_rsb, (x), (y))
+#define CACHE_SUM_GLOBAL_DYN_STAT(x, y)                         \
+  do {                                                          \
+    RecIncrGlobalRawStatSum(cache_rsb, (x), (y));               \
+    RecIncrGlobalRawStatSum(vol->cache_vol->vol_rsb, (x), (y)); \
+  } while (0);
 
 #define CACHE_CLEAR_DYN_STAT(x)                          \
   do {                                                   \
@@ -206,6 +221,10 @@ extern RecRawStatBlock *cache_rsb;
 
 // Configuration
 extern int cache_config_dir_sync_frequency;
+extern int cache_config_dir_sync_incremental;
+extern int cache_config_dir_sync_max_write;
+extern int cache_config_dir_sync_delay;
+extern int cache_config_dir_load_mmap;
 extern int cache_config_http_max_alts;
 extern int cache_config_permit_pinning;
 extern int cache_config_select_alternate;
@@ -216,9 +235,14 @@ extern int cache_config_enable_checksum;
 extern int cache_config_alt_rewrite_max_size;
 extern int cache_config_read_while_writer;
 extern int cache_config_agg_write_backlog;
+extern int cache_config_agg_write_direct_size;
+extern int cache_config_agg_write_fill_time;
 extern int cache_config_ram_cache_compress;
 extern int cache_config_ram_cache_compress_percent;
+extern int cache_config_ram_cache_compress_adaptive;
+extern int cache_config_ram_cache_zstd_level;
 extern int cache_config_ram_cache_use_seen_filter;
+extern int cache_config_ram_cache_zero_copy_hits;
 extern int cache_config_hit_evacuate_percent;
 extern int cache_config_hit_evacuate_size_limit;
 extern int cache_config_force_sector_size;
@@ -314,9 +338,11 @@ struct CacheVC : public CacheVConnection {
   int do_write_call();
   int do_write_lock();
   int do_write_lock_call();
+  void direct_write_prepare();
   int do_sync(uint32_t target_write_serial);
 
   int openReadClose(int event, Event *e);
+  int openReadHotObject(int event, Event *e);
   int openReadReadDone(int event, Event *e);
   int openReadMain(int event, Event *e);
   int openReadStartEarliest(int event, Event *e);
@@ -371,6 +397,7 @@ struct CacheVC : public CacheVConnection {
     io.aiocb.aio_fildes = AIO_AGG_WRITE_IN_PROGRESS;
   }
   int evacuateDocDone(int event, Event *e);
+  int tierMoveDocDone(int event, Event *e);
   int evacuateReadHead(int event, Event *e);
 
   void cancel_trigger();
@@ -475,6 +502,10 @@ struct CacheVC : public CacheVConnection {
   int header_to_write_len;
   void *header_to_write;
   short writer_lock_retry;
+  uint32_t hot_epoch;  // hot object epoch of first_key when the read started
+  Vol *tier_vol;       // volume of the other tier of a tiered host record
+  uint32_t tier_epoch; // tier epoch of first_key when vol was chosen
+  char *direct_buf;    // the Doc of a large fragment, built before the volume lock is taken
   union {
     uint32_t flags;
     struct {
@@ -499,6 +530,8 @@ struct CacheVC : public CacheVConnection {
       unsigned int hit_evacuate : 1;
       unsigned int compressed_in_ram : 1; // compressed state in ram cache
       unsigned int allow_empty_doc : 1;   // used for cache empty http document
+      unsigned int hot_candidate : 1;     // may be added to the hot objects of this thread
+      unsigned int hot_object : 1;        // served from the hot objects of this thread
     } f;
   };
   // BTF optimization used to skip reading stuff in cache partition that doesn't contain any
@@ -606,6 +639,9 @@ free_CacheVC(CacheVC *cont)
   if (cont->scan_vol_map) {
     ats_free(cont->scan_vol_map);
   }
+  if (cont->direct_buf) {
+    ats_memalign_free(cont->direct_buf);
+  }
   memset((char *)&cont->vio, 0, cont->size_to_init);
 #ifdef CACHE_STAT_PAGES
   ink_assert(!cont->stat_link.next && !cont->stat_link.prev);
@@ -729,6 +765,7 @@ CacheVC::do_write_lock()
 TS_INLINE int
 CacheVC::do_write_lock_call()
 {
+  direct_write_prepare();
   PUSH_HANDLER(&CacheVC::handleWriteLock);
   return handleWriteLock(EVENT_CALL, nullptr);
 }
@@ -762,6 +799,7 @@ Vol::close_write(CacheVC *cont)
   stat_cache_vcs.remove(cont, cont->stat_link);
   ink_assert(!cont->stat_link.next && !cont->stat_link.prev);
 #endif
+  hot_object_invalidate(&cont->first_key);
   return open_dir.close_write(cont);
 }
 
@@ -781,12 +819,20 @@ Vol::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
     CACHE_INCREMENT_DYN_STAT(cache_write_backlog_failure_stat);
     return ECACHE_WRITE_FAIL;
   }
+  // the document was moved to the other tier after this volume was chosen
+  if (cont->tier_vol && cache_tier_epoch(&cont->first_key) != cont->tier_epoch) {
+    return ECACHE_DOC_BUSY;
+  }
   if (open_dir.open_write(cont, allow_if_writers, max_writers)) {
 #ifdef CACHE_STAT_PAGES
     ink_assert(cont->mutex->thread_holding == this_ethread());
     ink_assert(!cont->stat_link.next && !cont->stat_link.prev);
     stat_cache_vcs.enqueue(cont, cont->stat_link);
 #endif
+    hot_object_invalidate(&cont->first_key);
+    if (cont->tier_vol && cache_vol->tier == CACHE_TIER_SSD && !dir_probe_miss(&cont->first_key, cont->tier_vol)) {
+      cache_tier_forget(cont->tier_vol, &cont->first_key);
+    }
     return 0;
   }
   return ECACHE_DOC_BUSY;
@@ -1005,7 +1051,9 @@ struct Cache {
 
   int open_done();
 
-  Vol *key_to_vol(const CacheKey *key, const char *hostname, int host_len);
+  CacheHostRecord *key_to_host_record(const char *hostname, int host_len);
+  Vol *key_to_vol(const CacheKey *key, const char *hostname, int host_len, Vol **other_tier = nullptr);
+  Vol *key_to_tier_vol(const CacheKey *key, const char *hostname, int host_len, int tier);
 
   Cache() {}
 };
@@ -0,0 +1,72 @@
+/** @file
+
+  Moves documents between the SSD and the HDD tier of a host record.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "I_Cache.h"
+
+/*
+  A host record with both SSD and HDD volumes (tier=ssd in volume.config)
+  keeps each document in exactly one of its tiers. Cache::key_to_vol looks in
+  the SSD tier first and falls back to the HDD tier when the SSD directory
+  definitely does not have the key.
+
+  A document read often from the HDD tier is promoted: its Docs are read raw
+  from the HDD volume and written through the aggregation buffer of the SSD
+  volume, like an evacuation. Documents in the SSD region the write position
+  is about to overwrite are demoted the same way. A move only commits, by
+  moving the directory entries from one volume to the other, if no writer or
+  remove touched the document in the meantime. Writers which chose a volume
+  before a move committed get ECACHE_DOC_BUSY from Vol::open_write.
+
+  Only HTTP documents with a single alternate whose data is in one fragment
+  are moved.
+*/
+
+#define CACHE_TIER_EPOCHS (1 << 16) // move epochs, shared by keys with the same hash
+#define CACHE_TIER_MAX_MOVES 64     // moves in progress at once
+
+struct Vol;
+
+extern std::atomic<uint32_t> cache_tier_epochs[CACHE_TIER_EPOCHS];
+
+extern int cache_config_tier_promote_hits;
+extern int cache_config_tier_max_size;
+extern int cache_config_tier_demote;
+extern int cache_config_tier_admit;
+
+inline uint32_t
+cache_tier_epoch(const CacheKey *key)
+{
+  return cache_tier_epochs[key->slice32(1) & (CACHE_TIER_EPOCHS - 1)].load(std::memory_order_acquire);
+}
+
+// Counts a read of @a key from the HDD tier, returns true if the document should be promoted.
+bool cache_tier_hit(const CacheKey *key);
+// Moves the document for @a key with the head Doc at @a head from @a from to @a to. The
+// epochs are those of the tier and the hot objects for the key when @a from was chosen.
+void cache_tier_move(Vol *from, Vol *to, const CacheKey *key, const Dir *head, uint32_t tier_epoch, uint32_t epoch);
+// Removes the stale directory entries for @a key from @a vol.
+void cache_tier_forget(Vol *vol, const CacheKey *key);
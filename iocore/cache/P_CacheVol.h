@@ -38,6 +38,7 @@
 #define START_POS ((off_t)START_BLOCKS * CACHE_BLOCK_SIZE)
 #define AGG_SIZE (4 * 1024 * 1024)     // 4MB
 #define AGG_HIGH_WATER (AGG_SIZE / 2)  // 2MB
+#define AGG_LOW_WATER (AGG_SIZE / 16)  // 256K, least adaptive high water
 #define EVACUATION_SIZE (2 * AGG_SIZE) // 8MB
 #define MAX_VOL_SIZE ((off_t)512 * 1024 * 1024 * 1024 * 1024)
 #define STORE_BLOCKS_PER_CACHE_BLOCK (STORE_BLOCK_SIZE / CACHE_BLOCK_SIZE)
@@ -51,11 +52,16 @@
 #define LOOKASIDE_SIZE 256
 #define EVACUATION_BUCKET_SIZE (2 * EVACUATION_SIZE) // 16MB
 #define RECOVERY_SIZE EVACUATION_SIZE                // 8MB
+#define DIR_LOAD_SIZE (16 * 1024 * 1024)             // 16MB
 #define AIO_NOT_IN_PROGRESS 0
 #define AIO_AGG_WRITE_IN_PROGRESS -1
 #define AUTO_SIZE_RAM_CACHE -1                               // 1-1 with directory size
 #define DEFAULT_TARGET_FRAGMENT_SIZE (1048576 - sizeof(Doc)) // 1MB
 
+// Storage tiers of a volume, see volume.config
+#define CACHE_TIER_HDD 0 // capacity tier, the default
+#define CACHE_TIER_SSD 1 // fast tier in front of the capacity volumes of the same host record
+
 #define dir_offset_evac_bucket(_o) (_o / (EVACUATION_BUCKET_SIZE / CACHE_BLOCK_SIZE))
 #define dir_evac_bucket(_e) dir_offset_evac_bucket(dir_offset(_e))
 #define offset_evac_bucket(_d, _o) \
@@ -130,6 +136,7 @@ struct Vol : public Continuation {
   VolHeaderFooter *header = nullptr;
   VolHeaderFooter *footer = nullptr;
   int segments            = 0;
+  DirSegmentSeq *seg_seq  = nullptr;
   off_t buckets           = 0;
   off_t recover_pos       = 0;
   off_t prev_recover_pos  = 0;
@@ -144,9 +151,12 @@ struct Vol : public Continuation {
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
-  char *agg_buffer  = nullptr;
-  int agg_todo_size = 0;
-  int agg_buf_pos   = 0;
+  char *agg_buffer          = nullptr; // the buffer being filled or written
+  char *agg_main_buffer     = nullptr; // the aggregation buffer, agg_buffer unless a large fragment is written directly
+  int agg_todo_size         = 0;
+  int agg_buf_pos           = 0;
+  int agg_high_water        = AGG_HIGH_WATER; // agg_buf_pos at which the buffer is written
+  ink_hrtime agg_fill_start = 0;              // when the first Doc was copied into the buffer
 
   Event *trigger = nullptr;
 
@@ -168,7 +178,9 @@ struct Vol : public Continuation {
   bool recover_wrapped       = false;
   bool dir_sync_waiting      = false;
   bool dir_sync_in_progress  = false;
+  int dir_sync_full          = 2; // syncs which must write every segment before they can be incremental
   bool writing_end_marker    = false;
+  uint64_t init_dir_entries  = 0; // directory entries in use after recovery
 
   CacheKey first_fragment_key;
   int64_t first_fragment_offset = 0;
@@ -194,6 +206,8 @@ struct Vol : public Continuation {
   int clear_dir();
 
   int init(char *s, off_t blocks, off_t dir_skip, bool clear);
+  int load_dir(off_t dir_offset);
+  bool load_dir_mmap(off_t dir_offset);
 
   int handle_dir_clear(int event, void *data);
   int handle_dir_read(int event, void *data);
@@ -238,6 +252,7 @@ struct Vol : public Continuation {
   int evac_range(off_t start, off_t end, int evac_phase);
   void periodic_scan();
   void scan_for_pinned_documents();
+  void scan_for_demotion();
   void evacuate_cleanup_blocks(int i);
   void evacuate_cleanup();
   EvacuationBlock *force_evacuate_head(Dir *dir, int pinned);
@@ -266,10 +281,20 @@ struct Vol : public Continuation {
     open_dir.mutex = mutex;
     agg_buffer     = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
     memset(agg_buffer, 0, AGG_SIZE);
+    ink_aio_register_buffer(agg_buffer, AGG_SIZE);
+    agg_main_buffer = agg_buffer;
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() override { ats_memalign_free(agg_buffer); }
+  ~Vol() override
+  {
+    if (agg_buffer != agg_main_buffer) {
+      ats_memalign_free(agg_buffer);
+    }
+    ink_aio_unregister_buffer(agg_main_buffer);
+    ats_memalign_free(agg_main_buffer);
+    delete[] seg_seq;
+  }
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -284,6 +309,7 @@ struct CacheVol {
   off_t size            = 0;
   int num_vols          = 0;
   bool ramcache_enabled = true;
+  int tier              = CACHE_TIER_HDD;
   Vol **vols            = nullptr;
   DiskVol **disk_vols   = nullptr;
   LINK(CacheVol, link);
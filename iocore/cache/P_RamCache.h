@@ -32,8 +32,9 @@ class RamCache
 public:
   // returns 1 on found/stored, 0 on not found/stored, if provided auxkey1 and auxkey2 must match
   virtual int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0) = 0;
+  // @a content is from ram_cache_content() and is only a hint for compression
   virtual int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint32_t auxkey1 = 0,
-                  uint32_t auxkey2 = 0)                                                                     = 0;
+                  uint32_t auxkey2 = 0, uint32_t content = 0)                                               = 0;
   virtual int fixup(const CryptoHash *key, uint32_t old_auxkey1, uint32_t old_auxkey2, uint32_t new_auxkey1,
                     uint32_t new_auxkey2)                                                                   = 0;
   virtual int64_t size() const                                                                              = 0;
@@ -44,3 +45,12 @@ public:
 
 RamCache *new_RamCacheLRU();
 RamCache *new_RamCacheCLFUS();
+RamCache *new_RamCacheTinyLFU();
+
+// Content classes for RAM cache compression, with a dictionary index in the higher bits.
+enum RamCacheContent { RAM_CACHE_CONTENT_UNKNOWN, RAM_CACHE_CONTENT_TEXT, RAM_CACHE_CONTENT_COMPRESSED };
+#define RAM_CACHE_CONTENT_CLASS(_c) ((_c)&0xFF)
+#define RAM_CACHE_CONTENT_DICT(_c) ((_c) >> 8)
+
+uint32_t ram_cache_content(const char *content_type, int len, bool encoded);
+void ram_cache_compress_init();
@@ -33,12 +33,20 @@
 #ifdef HAVE_LZMA_H
 #include <lzma.h>
 #endif
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+#include <dirent.h>
+#include <string>
+#include <vector>
 
 #define REQUIRED_COMPRESSION 0.9 // must get to this size or declared incompressible
 #define REQUIRED_SHRINK 0.8      // must get to this size or keep original buffer (with padding)
 #define HISTORY_HYSTERIA 10      // extra temporary history
 #define ENTRY_OVERHEAD 256       // per-entry overhead to consider when computing cache value/size
 #define LZMA_BASE_MEMLIMIT (64 * 1024 * 1024)
+#define MAX_ZSTD_DICTIONARIES 255
+#define MAX_ZSTD_DICTIONARY_SIZE (1024 * 1024)
 //#define CHECK_ACOUNTING 1 // very expensive double checking of all sizes
 
 #define REQUEUE_HITS(_h) ((_h) ? ((_h)-1) : 0)
@@ -61,7 +69,9 @@ struct RamCacheCLFUSEntry {
       uint32_t compressed : 3; // compression type
       uint32_t incompressible : 1;
       uint32_t lru : 1;
-      uint32_t copy : 1; // copy-in-copy-out
+      uint32_t copy : 1;    // copy-in-copy-out
+      uint32_t content : 2; // RamCacheContent
+      uint32_t dict : 8;    // zstd dictionary, 0 for none
     } flag_bits;
     uint32_t flags;
   };
@@ -77,8 +87,8 @@ public:
 
   // returns 1 on found/stored, 0 on not found/stored, if provided auxkey1 and auxkey2 must match
   int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0) override;
-  int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint32_t auxkey1 = 0,
-          uint32_t auxkey2 = 0) override;
+  int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0,
+          uint32_t content = 0) override;
   int fixup(const CryptoHash *key, uint32_t old_auxkey1, uint32_t old_auxkey2, uint32_t new_auxkey1, uint32_t new_auxkey2) override;
   int64_t size() const override;
 
@@ -108,6 +118,7 @@ private:
   void _move_compressed(RamCacheCLFUSEntry *e);
   RamCacheCLFUSEntry *_destroy(RamCacheCLFUSEntry *e);
   void _requeue_victims(Que(RamCacheCLFUSEntry, lru_link) & victims);
+  bool _share(RamCacheCLFUSEntry *e);
   void _tick(); // move CLOCK on history
 };
 
@@ -154,6 +165,11 @@ RamCacheCLFUSCompressor::mainEvent(int /* event ATS_UNUSED */, Event *e)
   case CACHE_COMPRESSION_LIBLZMA:
 #ifndef HAVE_LZMA_H
     Warning("lzma not available for RAM cache compression");
+#endif
+    break;
+  case CACHE_COMPRESSION_ZSTD:
+#ifndef HAVE_ZSTD_H
+    Warning("zstd not available for RAM cache compression");
 #endif
     break;
   }
@@ -163,6 +179,169 @@ RamCacheCLFUSCompressor::mainEvent(int /* event ATS_UNUSED */, Event *e)
   return EVENT_CONT;
 }
 
+#ifdef HAVE_ZSTD_H
+struct RamCacheZstdDictionary {
+  std::string content_type;
+  ZSTD_CDict *cdict;
+  ZSTD_DDict *ddict;
+};
+
+// Loaded at startup and read only afterwards, entries refer to them by index + 1.
+static std::vector<RamCacheZstdDictionary> zstd_dictionaries;
+
+static ZSTD_CCtx *
+zstd_cctx()
+{
+  static thread_local ZSTD_CCtx *cctx = ZSTD_createCCtx();
+  return cctx;
+}
+
+static ZSTD_DCtx *
+zstd_dctx()
+{
+  static thread_local ZSTD_DCtx *dctx = ZSTD_createDCtx();
+  return dctx;
+}
+#endif
+
+// Load the zstd dictionaries from proxy.config.cache.ram_cache.zstd_dictionaries. Each file in the
+// directory is a dictionary trained on one content type, e.g. text_html.dict for text/html.
+void
+ram_cache_compress_init()
+{
+#ifdef HAVE_ZSTD_H
+  std::string path = RecConfigReadConfigPath("proxy.config.cache.ram_cache.zstd_dictionaries");
+  if (cache_config_ram_cache_compress != CACHE_COMPRESSION_ZSTD || path.empty() || !zstd_dictionaries.empty()) {
+    return;
+  }
+  DIR *dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    Warning("unable to open RAM cache zstd dictionaries '%s': %s", path.c_str(), strerror(errno));
+    return;
+  }
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    size_t suffix    = name.size() > 5 ? name.size() - 5 : 0;
+    size_t sep       = name.find('_');
+    if (!suffix || name.compare(suffix, 5, ".dict") != 0 || sep == std::string::npos || sep >= suffix) {
+      continue;
+    }
+    if (zstd_dictionaries.size() >= MAX_ZSTD_DICTIONARIES) {
+      Warning("too many RAM cache zstd dictionaries in '%s', ignoring the rest", path.c_str());
+      break;
+    }
+    std::string file = path + "/" + name;
+    ats_scoped_fd fd(::open(file.c_str(), O_RDONLY));
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size <= 0 || st.st_size > MAX_ZSTD_DICTIONARY_SIZE) {
+      Warning("unable to load RAM cache zstd dictionary '%s'", file.c_str());
+      continue;
+    }
+    std::vector<char> buf(st.st_size);
+    if (read(fd, buf.data(), buf.size()) != static_cast<ssize_t>(buf.size())) {
+      Warning("unable to read RAM cache zstd dictionary '%s': %s", file.c_str(), strerror(errno));
+      continue;
+    }
+    RamCacheZstdDictionary dict;
+    dict.content_type      = name.substr(0, suffix);
+    dict.content_type[sep] = '/';
+    dict.cdict             = ZSTD_createCDict(buf.data(), buf.size(), cache_config_ram_cache_zstd_level);
+    dict.ddict             = ZSTD_createDDict(buf.data(), buf.size());
+    if (dict.cdict == nullptr || dict.ddict == nullptr) {
+      Warning("invalid RAM cache zstd dictionary '%s'", file.c_str());
+      ZSTD_freeCDict(dict.cdict);
+      ZSTD_freeDDict(dict.ddict);
+      continue;
+    }
+    Note("loaded RAM cache zstd dictionary for %s", dict.content_type.c_str());
+    zstd_dictionaries.push_back(dict);
+  }
+  closedir(dir);
+#endif
+}
+
+uint32_t
+ram_cache_content(const char *content_type, int len, bool encoded)
+{
+  static const char *compressed_types[] = {"image/", "video/", "audio/", "font/woff", "application/zip", "application/gzip",
+                                           "application/x-gzip", "application/zstd", "application/x-xz", "application/x-bzip2",
+                                           "application/x-7z-compressed", "application/vnd.rar"};
+  static const char *text_types[]       = {"text/", "json", "xml", "javascript", "ecmascript", "svg", "x-www-form-urlencoded"};
+
+  if (encoded) {
+    return RAM_CACHE_CONTENT_COMPRESSED;
+  }
+  if (content_type == nullptr || len <= 0) {
+    return RAM_CACHE_CONTENT_UNKNOWN;
+  }
+  // Lower case and drop any parameters, e.g. "; charset=utf-8".
+  std::string type;
+  for (int i = 0; i < len && content_type[i] != ';' && content_type[i] != ' '; i++) {
+    type += ParseRules::ink_tolower(content_type[i]);
+  }
+  uint32_t content = RAM_CACHE_CONTENT_UNKNOWN;
+  for (const char *t : text_types) {
+    if (type.find(t) != std::string::npos) {
+      content = RAM_CACHE_CONTENT_TEXT;
+      break;
+    }
+  }
+  if (content == RAM_CACHE_CONTENT_UNKNOWN) {
+    for (const char *t : compressed_types) {
+      if (type.compare(0, strlen(t), t) == 0) {
+        return RAM_CACHE_CONTENT_COMPRESSED;
+      }
+    }
+  }
+#ifdef HAVE_ZSTD_H
+  for (size_t i = 0; i < zstd_dictionaries.size(); i++) {
+    if (zstd_dictionaries[i].content_type == type) {
+      content |= (i + 1) << 8;
+      break;
+    }
+  }
+#endif
+  return content;
+}
+
+// Whether the document in @a data starts with the signature of an already compressed format.
+static bool
+looks_compressed(IOBufferData *data, uint32_t len)
+{
+  static const struct {
+    int offset;
+    int len;
+    const char *magic;
+  } signatures[] = {
+    {0, 2, "\x1f\x8b"},                 // gzip
+    {0, 4, "\x28\xb5\x2f\xfd"},         // zstd
+    {0, 6, "\xfd\x37\x7a\x58\x5a\x00"}, // xz
+    {0, 3, "BZh"},                      // bzip2
+    {0, 4, "PK\x03\x04"},               // zip and its derivatives
+    {0, 4, "\x89PNG"},                  // png
+    {0, 3, "\xff\xd8\xff"},             // jpeg
+    {0, 4, "GIF8"},                     // gif
+    {8, 4, "WEBP"},                     // webp
+    {4, 4, "ftyp"},                     // mp4, mov, avif, heic
+    {0, 4, "\x1a\x45\xdf\xa3"},         // matroska, webm
+    {0, 4, "wOF2"},                     // woff2
+    {0, 4, "OggS"},                     // ogg
+    {0, 3, "ID3"},                      // mp3
+  };
+
+  Doc *doc = reinterpret_cast<Doc *>(data->data());
+  if (len < sizeof(Doc) || doc->magic != DOC_MAGIC || sizeof(Doc) + doc->hlen + 12 > len) {
+    return false;
+  }
+  const char *body = doc->data();
+  for (const auto &s : signatures) {
+    if (memcmp(body + s.offset, s.magic, s.len) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 ClassAllocator<RamCacheCLFUSEntry> ramCacheCLFUSEntryAllocator("RamCacheCLFUSEntry");
 
 static const int bucket_sizes[] = {127,      251,      509,       1021,      2039,      4093,       8191,      16381,   32749,
@@ -290,11 +469,23 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey
             ram_hit_state = RAM_HIT_COMPRESS_LIBLZMA;
             break;
           }
+#endif
+#ifdef HAVE_ZSTD_H
+          case CACHE_COMPRESSION_ZSTD: {
+            size_t l = e->flag_bits.dict ? ZSTD_decompress_usingDDict(zstd_dctx(), b, e->len, e->data->data(), e->compressed_len,
+                                                                      zstd_dictionaries[e->flag_bits.dict - 1].ddict) :
+                                           ZSTD_decompressDCtx(zstd_dctx(), b, e->len, e->data->data(), e->compressed_len);
+            if (ZSTD_isError(l) || l != e->len) {
+              goto Lfailed;
+            }
+            ram_hit_state = RAM_HIT_COMPRESS_ZSTD;
+            break;
+          }
 #endif
           }
           IOBufferData *data = new_xmalloc_IOBufferData(b, e->len);
           data->_mem_type    = DEFAULT_ALLOC;
-          if (!e->flag_bits.copy) { // don't bother if we have to copy anyway
+          if (!e->flag_bits.copy || this->_share(e)) { // don't bother if we have to copy anyway
             int64_t delta = (static_cast<int64_t>(e->compressed_len)) - static_cast<int64_t>(e->size);
             this->_bytes += delta;
             CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, delta);
@@ -306,7 +497,7 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey
           (*ret_data) = data;
         } else {
           IOBufferData *data = e->data.get();
-          if (e->flag_bits.copy) {
+          if (e->flag_bits.copy && !this->_share(e)) {
             data = new_IOBufferData(iobuffer_size_to_index(e->len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
             ::memcpy(data->data(), e->data->data(), e->len);
           }
@@ -335,6 +526,22 @@ Lfailed:
   goto Lerror;
 }
 
+// Hot copy-in-copy-out entries are handed out by reference so that cache hits can
+// chain the RAM cache block directly into the client buffer. The reader unmarshals
+// the doc in place, so the entry can no longer be compressed afterwards.
+bool
+RamCacheCLFUS::_share(RamCacheCLFUSEntry *e)
+{
+  if (!cache_config_ram_cache_zero_copy_hits || e->hits < static_cast<uint64_t>(cache_config_ram_cache_zero_copy_hits)) {
+    return false;
+  }
+  e->flag_bits.copy           = 0;
+  e->flag_bits.incompressible = 1;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_zero_copy_stat, 1);
+  DDebug("ram_cache", "get %X %d %d SHARED", e->key.slice32(3), e->auxkey1, e->auxkey2);
+  return true;
+}
+
 void
 RamCacheCLFUS::_tick()
 {
@@ -438,6 +645,15 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       e->compressed_len = e->size;
       uint32_t l        = 0;
       int ctype         = cache_config_ram_cache_compress;
+      bool probe        = false; // try fastlz first and give up if that does not compress
+      if (cache_config_ram_cache_compress_adaptive) {
+        if (e->flag_bits.content == RAM_CACHE_CONTENT_COMPRESSED || looks_compressed(e->data.get(), e->len)) {
+          CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_compress_skipped_stat, 1);
+          e->flag_bits.incompressible = 1;
+          goto Lcontinue;
+        }
+        probe = e->flag_bits.content == RAM_CACHE_CONTENT_UNKNOWN && ctype != CACHE_COMPRESSION_FASTLZ;
+      }
       switch (ctype) {
       default:
         goto Lcontinue;
@@ -453,16 +669,35 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
       case CACHE_COMPRESSION_LIBLZMA:
         l = e->len;
         break;
+#endif
+#ifdef HAVE_ZSTD_H
+      case CACHE_COMPRESSION_ZSTD:
+        l = static_cast<uint32_t>(ZSTD_compressBound(e->len));
+        break;
 #endif
       }
+      if (probe) {
+        l = std::max(l, static_cast<uint32_t>(static_cast<double>(e->len) * 1.05 + 66));
+      }
       // store transient data for lock release
       Ptr<IOBufferData> edata = e->data;
       uint32_t elen           = e->len;
+      uint32_t dict           = e->flag_bits.dict;
       CryptoHash key          = e->key;
       MUTEX_UNTAKE_LOCK(vol->mutex, thread);
       b           = static_cast<char *>(ats_malloc(l));
       bool failed = false;
+      if (probe) {
+        int ll = elen < 16 ? 0 : fastlz_compress(edata->data(), elen, b);
+        if (ll <= 0 || ll > REQUIRED_COMPRESSION * elen) {
+          CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_compress_skipped_stat, 1);
+          failed = true;
+          ctype  = CACHE_COMPRESSION_NONE;
+        }
+      }
       switch (ctype) {
+      case CACHE_COMPRESSION_NONE:
+        break;
       default:
         goto Lfailed;
       case CACHE_COMPRESSION_FASTLZ:
@@ -494,14 +729,22 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
         l = static_cast<int>(pos);
         break;
       }
+#endif
+#ifdef HAVE_ZSTD_H
+      case CACHE_COMPRESSION_ZSTD: {
+        size_t ll = dict ? ZSTD_compress_usingCDict(zstd_cctx(), b, l, edata->data(), elen, zstd_dictionaries[dict - 1].cdict) :
+                           ZSTD_compressCCtx(zstd_cctx(), b, l, edata->data(), elen, cache_config_ram_cache_zstd_level);
+        if (ZSTD_isError(ll)) {
+          failed = true;
+        }
+        l = static_cast<uint32_t>(ll);
+        break;
+      }
 #endif
       }
       MUTEX_TAKE_LOCK(vol->mutex, thread);
       // see if the entry is till around
       {
-        if (failed) {
-          goto Lfailed;
-        }
         uint32_t i             = key.slice32(3) % this->_nbuckets;
         RamCacheCLFUSEntry *ee = this->_bucket[i].head;
         while (ee) {
@@ -515,6 +758,9 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
           ats_free(b);
           goto Lcontinue;
         }
+        if (failed) {
+          goto Lfailed;
+        }
       }
       if (l > REQUIRED_COMPRESSION * e->len) {
         e->flag_bits.incompressible = true;
@@ -523,7 +769,7 @@ RamCacheCLFUS::compress_entries(EThread *thread, int do_at_most)
         goto Lfailed;
       }
       if (l < e->len) {
-        e->flag_bits.compressed = cache_config_ram_cache_compress;
+        e->flag_bits.compressed = ctype;
         bb                      = static_cast<char *>(ats_malloc(l));
         memcpy(bb, b, l);
         ats_free(b);
@@ -576,7 +822,8 @@ void RamCacheCLFUS::_requeue_victims(Que(RamCacheCLFUSEntry, lru_link) & victims
 }
 
 int
-RamCacheCLFUS::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy, uint32_t auxkey1, uint32_t auxkey2)
+RamCacheCLFUS::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy, uint32_t auxkey1, uint32_t auxkey2,
+                   uint32_t content)
 {
   if (!this->_max_bytes) {
     return 0;
@@ -618,6 +865,8 @@ RamCacheCLFUS::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy,
       check_accounting(this);
       e->flag_bits.copy       = copy;
       e->flag_bits.compressed = 0;
+      e->flag_bits.content    = RAM_CACHE_CONTENT_CLASS(content);
+      e->flag_bits.dict       = RAM_CACHE_CONTENT_DICT(content);
       DDebug("ram_cache", "put %X %d %d size %d HIT", key->slice32(3), auxkey1, auxkey2, e->size);
       return 1;
     } else {
@@ -724,7 +973,9 @@ Linsert:
     e->data            = new_xmalloc_IOBufferData(b, len);
     e->data->_mem_type = DEFAULT_ALLOC;
   }
-  e->flag_bits.copy = copy;
+  e->flag_bits.copy    = copy;
+  e->flag_bits.content = RAM_CACHE_CONTENT_CLASS(content);
+  e->flag_bits.dict    = RAM_CACHE_CONTENT_DICT(content);
   this->_bytes += size + ENTRY_OVERHEAD;
   CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, size);
   e->size = size;
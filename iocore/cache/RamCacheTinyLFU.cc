@@ -0,0 +1,386 @@
+/** @file
+
+  A brief file description
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// Window TinyLFU (W-TinyLFU) replacement policy
+// See "TinyLFU: A Highly Efficient Cache Admission Policy", Einziger, Friedman and Manes.
+//
+// New entries go into a small LRU window. Entries leaving the window are only admitted to the
+// main segmented LRU if they have been requested more often than the entry they would displace,
+// according to a count-min sketch of recent request frequencies. The sketch replaces the seen
+// filter of the other RAM caches.
+
+#include "P_Cache.h"
+
+#define ENTRY_OVERHEAD 128      // per-entry overhead to consider when computing sizes
+#define WINDOW_PERCENT 1        // of the bytes for the window LRU
+#define PROTECTED_PERCENT 80    // of the bytes of the main LRU for entries hit while in it
+#define SKETCH_DEPTH 4          // counters per key
+#define SKETCH_SAMPLE_FACTOR 10 // counters are halved after this many increments per counter in a row
+#define SKETCH_MIN_WIDTH 1024
+#define SKETCH_MAX_WIDTH (1 << 26)
+
+enum RamCacheTinyLFUQueue { TINYLFU_WINDOW, TINYLFU_PROBATION, TINYLFU_PROTECTED, TINYLFU_QUEUES };
+
+struct RamCacheTinyLFUEntry {
+  CryptoHash key;
+  uint32_t auxkey1;
+  uint32_t auxkey2;
+  uint32_t size; // block size plus ENTRY_OVERHEAD
+  uint32_t queue;
+  LINK(RamCacheTinyLFUEntry, lru_link);
+  LINK(RamCacheTinyLFUEntry, hash_link);
+  Ptr<IOBufferData> data;
+};
+
+// Count-min sketch of 4 bit counters, 16 to a word.
+class RamCacheTinyLFUSketch
+{
+public:
+  void init(int64_t entries);
+  void increment(const CryptoHash *key);
+  int estimate(const CryptoHash *key) const;
+  ~RamCacheTinyLFUSketch() { ats_free(_table); }
+
+private:
+  uint64_t *_table     = nullptr;
+  uint32_t _mask       = 0; // width - 1, the width of each row is a power of 2
+  int64_t _samples     = 0;
+  int64_t _max_samples = 0;
+
+  void _reset();
+  // Index of the counter in row @a i for @a key.
+  uint32_t
+  _index(const CryptoHash *key, int i) const
+  {
+    return i * (_mask + 1) + (key->slice32(i) & _mask);
+  }
+};
+
+void
+RamCacheTinyLFUSketch::init(int64_t entries)
+{
+  uint32_t width = SKETCH_MIN_WIDTH;
+  while (width < entries && width < SKETCH_MAX_WIDTH) {
+    width <<= 1;
+  }
+  ats_free(_table);
+  size_t s     = SKETCH_DEPTH * width / 16 * sizeof(uint64_t);
+  _table       = static_cast<uint64_t *>(ats_malloc(s));
+  _mask        = width - 1;
+  _samples     = 0;
+  _max_samples = static_cast<int64_t>(width) * SKETCH_SAMPLE_FACTOR;
+  memset(_table, 0, s);
+}
+
+void
+RamCacheTinyLFUSketch::increment(const CryptoHash *key)
+{
+  bool added = false;
+  for (int i = 0; i < SKETCH_DEPTH; i++) {
+    uint32_t c     = _index(key, i);
+    uint64_t &word = _table[c >> 4];
+    int shift      = (c & 15) << 2;
+    if (((word >> shift) & 0xF) != 0xF) {
+      word += static_cast<uint64_t>(1) << shift;
+      added = true;
+    }
+  }
+  if (added && ++_samples >= _max_samples) {
+    _reset();
+  }
+}
+
+int
+RamCacheTinyLFUSketch::estimate(const CryptoHash *key) const
+{
+  int f = 0xF;
+  for (int i = 0; i < SKETCH_DEPTH; i++) {
+    uint32_t c = _index(key, i);
+    f          = std::min(f, static_cast<int>((_table[c >> 4] >> ((c & 15) << 2)) & 0xF));
+  }
+  return f;
+}
+
+// Age the sketch by halving every counter, so that it follows changes in popularity.
+void
+RamCacheTinyLFUSketch::_reset()
+{
+  for (uint64_t i = 0; i < SKETCH_DEPTH * (static_cast<uint64_t>(_mask) + 1) / 16; i++) {
+    _table[i] = (_table[i] >> 1) & 0x7777777777777777ULL;
+  }
+  _samples /= 2;
+}
+
+class RamCacheTinyLFU : public RamCache
+{
+public:
+  // returns 1 on found/stored, 0 on not found/stored, if provided auxkey1 and auxkey2 must match
+  int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0) override;
+  int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint32_t auxkey1 = 0, uint32_t auxkey2 = 0,
+          uint32_t content = 0) override;
+  int fixup(const CryptoHash *key, uint32_t old_auxkey1, uint32_t old_auxkey2, uint32_t new_auxkey1, uint32_t new_auxkey2) override;
+  int64_t size() const override;
+
+  void init(int64_t max_bytes, Vol *vol) override;
+
+  Vol *vol = nullptr; // for stats
+private:
+  int64_t _max_bytes = 0;
+  int64_t _objects   = 0;
+  int64_t _bytes[TINYLFU_QUEUES]     = {0};
+  int64_t _max_queue[TINYLFU_QUEUES] = {0};
+
+  int _ibuckets                                   = 0;
+  int _nbuckets                                   = 0;
+  DList(RamCacheTinyLFUEntry, hash_link) *_bucket = nullptr;
+  Que(RamCacheTinyLFUEntry, lru_link) _lru[TINYLFU_QUEUES];
+  RamCacheTinyLFUSketch _sketch;
+
+  void _resize_hashtable();
+  void _move(RamCacheTinyLFUEntry *e, int queue);
+  void _evict_window();
+  RamCacheTinyLFUEntry *_destroy(RamCacheTinyLFUEntry *e);
+};
+
+ClassAllocator<RamCacheTinyLFUEntry> ramCacheTinyLFUEntryAllocator("RamCacheTinyLFUEntry");
+
+static const int bucket_sizes[] = {127,     251,      509,      1021,     2039,      4093,      8191,     16381,
+                                   32749,   65521,    131071,   262139,   524287,    1048573,   2097143,  4194301,
+                                   8388593, 16777213, 33554393, 67108859, 134217689, 268435399, 536870909};
+
+int64_t
+RamCacheTinyLFU::size() const
+{
+  int64_t s = 0;
+  for (const auto &lru : _lru) {
+    forl_LL(RamCacheTinyLFUEntry, e, lru)
+    {
+      s += sizeof(*e);
+      s += sizeof(*e->data);
+      s += e->data->block_size();
+    }
+  }
+  return s;
+}
+
+void
+RamCacheTinyLFU::_resize_hashtable()
+{
+  int anbuckets = bucket_sizes[_ibuckets];
+  DDebug("ram_cache", "resize hashtable %d", anbuckets);
+  int64_t s                                          = anbuckets * sizeof(DList(RamCacheTinyLFUEntry, hash_link));
+  DList(RamCacheTinyLFUEntry, hash_link) *new_bucket = static_cast<DList(RamCacheTinyLFUEntry, hash_link) *>(ats_malloc(s));
+  memset(static_cast<void *>(new_bucket), 0, s);
+  if (_bucket) {
+    for (int64_t i = 0; i < _nbuckets; i++) {
+      RamCacheTinyLFUEntry *e = nullptr;
+      while ((e = _bucket[i].pop())) {
+        new_bucket[e->key.slice32(3) % anbuckets].push(e);
+      }
+    }
+    ats_free(_bucket);
+  }
+  _bucket   = new_bucket;
+  _nbuckets = anbuckets;
+}
+
+void
+RamCacheTinyLFU::init(int64_t abytes, Vol *avol)
+{
+  vol        = avol;
+  _max_bytes = abytes;
+  DDebug("ram_cache", "initializing ram_cache %" PRId64 " bytes", abytes);
+  if (!_max_bytes) {
+    return;
+  }
+  _max_queue[TINYLFU_WINDOW]    = _max_bytes * WINDOW_PERCENT / 100;
+  _max_queue[TINYLFU_PROTECTED] = (_max_bytes - _max_queue[TINYLFU_WINDOW]) * PROTECTED_PERCENT / 100;
+  _max_queue[TINYLFU_PROBATION] = _max_bytes - _max_queue[TINYLFU_WINDOW] - _max_queue[TINYLFU_PROTECTED];
+  _sketch.init(_max_bytes / std::max(cache_config_min_average_object_size, 1));
+  _resize_hashtable();
+}
+
+void
+RamCacheTinyLFU::_move(RamCacheTinyLFUEntry *e, int queue)
+{
+  _lru[e->queue].remove(e);
+  _bytes[e->queue] -= e->size;
+  e->queue = queue;
+  _lru[queue].enqueue(e);
+  _bytes[queue] += e->size;
+}
+
+RamCacheTinyLFUEntry *
+RamCacheTinyLFU::_destroy(RamCacheTinyLFUEntry *e)
+{
+  RamCacheTinyLFUEntry *ret = e->hash_link.next;
+  uint32_t b                = e->key.slice32(3) % _nbuckets;
+  _bucket[b].remove(e);
+  _lru[e->queue].remove(e);
+  _bytes[e->queue] -= e->size;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, -static_cast<int64_t>(e->size));
+  DDebug("ram_cache", "put %X %d %d FREED", e->key.slice32(3), e->auxkey1, e->auxkey2);
+  e->data = nullptr;
+  THREAD_FREE(e, ramCacheTinyLFUEntryAllocator, this_thread());
+  _objects--;
+  return ret;
+}
+
+// Move entries out of the window until it fits, admitting each to the main LRU only if it is
+// more popular than the main LRU entry it would displace.
+void
+RamCacheTinyLFU::_evict_window()
+{
+  while (_bytes[TINYLFU_WINDOW] > _max_queue[TINYLFU_WINDOW]) {
+    RamCacheTinyLFUEntry *candidate = _lru[TINYLFU_WINDOW].head;
+    int64_t main_bytes              = _bytes[TINYLFU_PROBATION] + _bytes[TINYLFU_PROTECTED];
+    int64_t max_main                = _max_queue[TINYLFU_PROBATION] + _max_queue[TINYLFU_PROTECTED];
+    if (main_bytes + candidate->size > max_main) {
+      RamCacheTinyLFUEntry *victim = _lru[TINYLFU_PROBATION].head;
+      if (!victim) {
+        victim = _lru[TINYLFU_PROTECTED].head;
+      }
+      if (!victim || _sketch.estimate(&candidate->key) <= _sketch.estimate(&victim->key)) {
+        DDebug("ram_cache", "put %X %d %d REJECTED", candidate->key.slice32(3), candidate->auxkey1, candidate->auxkey2);
+        _destroy(candidate);
+        continue;
+      }
+    }
+    _move(candidate, TINYLFU_PROBATION);
+    while (_bytes[TINYLFU_PROBATION] + _bytes[TINYLFU_PROTECTED] > max_main) {
+      RamCacheTinyLFUEntry *victim = _lru[TINYLFU_PROBATION].head;
+      if (!victim || victim == candidate) {
+        victim = _lru[TINYLFU_PROTECTED].head;
+      }
+      if (!victim) {
+        break;
+      }
+      _destroy(victim);
+    }
+  }
+}
+
+int
+RamCacheTinyLFU::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint32_t auxkey1, uint32_t auxkey2)
+{
+  if (!_max_bytes) {
+    return 0;
+  }
+  _sketch.increment(key);
+  uint32_t i              = key->slice32(3) % _nbuckets;
+  RamCacheTinyLFUEntry *e = _bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey1 == auxkey1 && e->auxkey2 == auxkey2) {
+      if (e->queue == TINYLFU_WINDOW) {
+        _move(e, TINYLFU_WINDOW);
+      } else {
+        _move(e, TINYLFU_PROTECTED);
+        // Demote the least recently used protected entries back to probation.
+        while (_bytes[TINYLFU_PROTECTED] > _max_queue[TINYLFU_PROTECTED] && _lru[TINYLFU_PROTECTED].head != e) {
+          _move(_lru[TINYLFU_PROTECTED].head, TINYLFU_PROBATION);
+        }
+      }
+      (*ret_data) = e->data;
+      DDebug("ram_cache", "get %X %d %d HIT", key->slice32(3), auxkey1, auxkey2);
+      CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_hits_stat, 1);
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  DDebug("ram_cache", "get %X %d %d MISS", key->slice32(3), auxkey1, auxkey2);
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_misses_stat, 1);
+  return 0;
+}
+
+// ignore 'copy' and 'content' since we don't touch the data
+int
+RamCacheTinyLFU::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool, uint32_t auxkey1, uint32_t auxkey2, uint32_t)
+{
+  if (!_max_bytes) {
+    return 0;
+  }
+  uint32_t i              = key->slice32(3) % _nbuckets;
+  RamCacheTinyLFUEntry *e = _bucket[i].head;
+  while (e) {
+    if (e->key == *key) {
+      if (e->auxkey1 == auxkey1 && e->auxkey2 == auxkey2) {
+        _move(e, e->queue);
+        return 1;
+      } else { // discard when aux keys conflict
+        e = _destroy(e);
+        continue;
+      }
+    }
+    e = e->hash_link.next;
+  }
+  uint32_t size = ENTRY_OVERHEAD + data->block_size();
+  if (size > _max_bytes - _max_queue[TINYLFU_WINDOW]) {
+    DDebug("ram_cache", "put %X %d %d len %d TOO LARGE", key->slice32(3), auxkey1, auxkey2, len);
+    return 0;
+  }
+  e          = THREAD_ALLOC(ramCacheTinyLFUEntryAllocator, this_ethread());
+  e->key     = *key;
+  e->auxkey1 = auxkey1;
+  e->auxkey2 = auxkey2;
+  e->size    = size;
+  e->queue   = TINYLFU_WINDOW;
+  e->data    = data;
+  _bucket[i].push(e);
+  _lru[TINYLFU_WINDOW].enqueue(e);
+  _bytes[TINYLFU_WINDOW] += size;
+  _objects++;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, size);
+  DDebug("ram_cache", "put %X %d %d INSERTED", key->slice32(3), auxkey1, auxkey2);
+  _evict_window();
+  if (_objects > _nbuckets) {
+    ++_ibuckets;
+    _resize_hashtable();
+  }
+  return 1;
+}
+
+int
+RamCacheTinyLFU::fixup(const CryptoHash *key, uint32_t old_auxkey1, uint32_t old_auxkey2, uint32_t new_auxkey1,
+                       uint32_t new_auxkey2)
+{
+  if (!_max_bytes) {
+    return 0;
+  }
+  uint32_t i              = key->slice32(3) % _nbuckets;
+  RamCacheTinyLFUEntry *e = _bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey1 == old_auxkey1 && e->auxkey2 == old_auxkey2) {
+      e->auxkey1 = new_auxkey1;
+      e->auxkey2 = new_auxkey2;
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  return 0;
+}
+
+RamCache *
+new_RamCacheTinyLFU()
+{
+  return new RamCacheTinyLFU;
+}
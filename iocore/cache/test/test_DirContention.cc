@@ -0,0 +1,179 @@
+/** @file
+
+  Contention benchmark for cache directory lookups.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#include <thread>
+#include <vector>
+
+#define PRESENT_KEYS 4096
+#define PROBES_PER_THREAD (256 * 1024)
+#define PROBE_THREADS 8
+
+namespace
+{
+void
+make_key(CacheKey *key, uint32_t i, uint32_t salt)
+{
+  uint32_t seed[2] = {i, salt};
+  CryptoContext().hash_immediate(*key, seed, sizeof(seed));
+}
+
+Dir
+make_dir(uint32_t i)
+{
+  Dir dir;
+  dir_clear(&dir);
+  dir_set_head(&dir, true);
+  dir_set_offset(&dir, i + 1);
+  return dir;
+}
+
+// Runs @a body on @a n threads which look like event threads to the lock macros.
+template <typename F>
+double
+run_threads(int n, F body)
+{
+  std::vector<std::thread> threads;
+  ink_hrtime start = Thread::get_hrtime_updated();
+  for (int i = 0; i < n; i++) {
+    threads.emplace_back([&body, i]() {
+      EThread *t = new EThread();
+      t->set_specific();
+      body(t, i);
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  return static_cast<double>(Thread::get_hrtime_updated() - start) / HRTIME_SECOND;
+}
+} // namespace
+
+class DirContentionTest : public CacheInit
+{
+public:
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    Vol *vol   = gvol[0];
+    EThread *t = this_ethread();
+    CacheKey key;
+
+    {
+      SCOPED_MUTEX_LOCK(lock, vol->mutex, t);
+      // Make the fake entries valid so that probes do not delete them.
+      write_pos              = vol->header->write_pos;
+      vol->header->write_pos = vol->start + (PRESENT_KEYS + 1) * CACHE_BLOCK_SIZE;
+      for (uint32_t i = 0; i < PRESENT_KEYS; i++) {
+        Dir dir = make_dir(i);
+        make_key(&key, i, 0);
+        REQUIRE(dir_insert(&key, vol, &dir));
+      }
+      // An unlocked miss must agree with the locked probe.
+      for (uint32_t i = 0; i < PRESENT_KEYS; i++) {
+        Dir result, *last_collision = nullptr;
+        make_key(&key, i, 0);
+        CHECK(!dir_probe_miss(&key, vol));
+        make_key(&key, i, 1);
+        if (dir_probe_miss(&key, vol)) {
+          CHECK(!dir_probe(&key, vol, &result, &last_collision));
+        }
+      }
+    }
+
+    std::atomic<uint64_t> locked_misses{0};
+    double locked = run_threads(PROBE_THREADS, [&](EThread *et, int n) {
+      CacheKey k;
+      uint64_t misses = 0;
+      for (uint32_t i = 0; i < PROBES_PER_THREAD; i++) {
+        Dir result, *last_collision = nullptr;
+        make_key(&k, i, n + 2);
+        SCOPED_MUTEX_LOCK(lock, vol->mutex, et);
+        misses += !dir_probe(&k, vol, &result, &last_collision);
+      }
+      locked_misses += misses;
+    });
+
+    // Keep a writer busy on the same volume while the readers run without the lock.
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> false_misses{0}, lock_free_misses{0};
+    std::thread writer([&]() {
+      EThread *et = new EThread();
+      et->set_specific();
+      CacheKey k;
+      for (uint32_t i = 0; !stop; i++) {
+        Dir dir = make_dir(i % PRESENT_KEYS);
+        make_key(&k, i % PRESENT_KEYS, 0xffff);
+        SCOPED_MUTEX_LOCK(lock, vol->mutex, et);
+        dir_insert(&k, vol, &dir);
+        dir_delete(&k, vol, &dir);
+      }
+    });
+    double lock_free = run_threads(PROBE_THREADS, [&](EThread *, int n) {
+      CacheKey k;
+      uint64_t misses = 0, bad = 0;
+      for (uint32_t i = 0; i < PROBES_PER_THREAD; i++) {
+        make_key(&k, i, n + 2);
+        misses += dir_probe_miss(&k, vol);
+        make_key(&k, i % PRESENT_KEYS, 0);
+        bad += dir_probe_miss(&k, vol);
+      }
+      lock_free_misses += misses;
+      false_misses += bad;
+    });
+    stop = true;
+    writer.join();
+
+    uint64_t probes = static_cast<uint64_t>(PROBE_THREADS) * PROBES_PER_THREAD;
+    printf("dir probe, %d threads: locked %.0f/s, lock free %.0f/s, lock free misses %" PRIu64 "/%" PRIu64 "\n", PROBE_THREADS,
+           probes / locked, 2 * probes / lock_free, lock_free_misses.load(), locked_misses.load());
+    CHECK(false_misses == 0);
+    CHECK(lock_free_misses > 0);
+
+    {
+      SCOPED_MUTEX_LOCK(lock, vol->mutex, t);
+      for (uint32_t i = 0; i < PRESENT_KEYS; i++) {
+        Dir dir = make_dir(i);
+        make_key(&key, i, 0);
+        dir_delete(&key, vol, &dir);
+      }
+      vol->header->write_pos = write_pos;
+    }
+
+    TEST_DONE();
+    delete this;
+    return 0;
+  }
+
+  off_t write_pos = 0;
+};
+
+TEST_CASE("cache directory contention", "cache")
+{
+  init_cache(256 * 1024 * 1024);
+  DirContentionTest *init = new DirContentionTest;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
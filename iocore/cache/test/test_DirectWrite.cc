@@ -0,0 +1,71 @@
+/** @file
+
+  Large fragments are written by themselves, not through the aggregation buffer.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#define LARGE_FILE 5 * 1024 * 1024
+#define SMALL_FILE 10 * 1024
+#define DIRECT_SIZE 512 * 1024
+
+class CacheDirectWriteInit : public CacheInit
+{
+public:
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    // Small documents before and after the large one share the aggregation buffer.
+    CacheTestHandler *h = new CacheTestHandler(SMALL_FILE, "http://www.scw44.com/small1");
+    h->add(new CacheTestHandler(LARGE_FILE, "http://www.scw44.com/large"));
+    h->add(new CacheTestHandler(SMALL_FILE, "http://www.scw44.com/small2"));
+    h->add(new TerminalTest);
+    this_ethread()->schedule_imm(h);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache direct write", "cache")
+{
+  // The data read back is compared with GLOBAL_DATA, make it differ from block to block.
+  char *data = const_cast<char *>(GLOBAL_DATA);
+  for (int i = 0; i < LARGE_FILE; i++) {
+    data[i] = static_cast<char>(i % 251);
+  }
+
+  init_cache(256 * 1024 * 1024);
+  cache_config_agg_write_direct_size = DIRECT_SIZE;
+  cache_config_agg_write_fill_time   = 100;
+  CacheDirectWriteInit *init         = new CacheDirectWriteInit;
+
+  this_ethread()->schedule_imm(init);
+  this_ethread()->execute();
+
+  int64_t direct = 0;
+  RecGetRawStatSum(cache_rsb, cache_agg_write_direct_stat, &direct);
+  CHECK(direct >= LARGE_FILE / DEFAULT_TARGET_FRAGMENT_SIZE);
+  for (int i = 0; i < gnvol; i++) {
+    CHECK(gvol[i]->agg_buffer == gvol[i]->agg_main_buffer);
+    CHECK(gvol[i]->agg_high_water >= AGG_LOW_WATER);
+    CHECK(gvol[i]->agg_high_water <= AGG_SIZE);
+  }
+}
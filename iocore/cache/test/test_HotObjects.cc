@@ -0,0 +1,109 @@
+/** @file
+
+  Reads of a popular document are answered from the hot objects of the thread.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#define SMALL_FILE 10 * 1024
+#define READS 6
+#define HOT_URL "http://www.scw22.com/"
+
+int hot_reads = 0;
+
+// Only reads the document, the write is done by the CacheTestHandler in front.
+class CacheHotReadTest : public CacheTestHandler
+{
+public:
+  CacheHotReadTest(size_t size, bool expect_hot) : _expect_hot(expect_hot)
+  {
+    this->_rt        = new CacheReadTest(size, this, HOT_URL);
+    this->_rt->mutex = this->mutex;
+    SET_HANDLER(&CacheHotReadTest::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    this_ethread()->schedule_imm(this->_rt);
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      CHECK(base->vc->f.hot_object == _expect_hot);
+      hot_reads += base->vc->f.hot_object;
+      base->do_io_read();
+      break;
+    case VC_EVENT_READ_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_READ_COMPLETE:
+      base->close();
+      delete this;
+      break;
+    default:
+      REQUIRE(false);
+      base->close();
+      delete this;
+      break;
+    }
+  }
+
+private:
+  bool _expect_hot;
+};
+
+class CacheHotObjectsInit : public CacheInit
+{
+public:
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    // The write and its read are the first two reads of the key.
+    CacheTestHandler *h = new CacheTestHandler(SMALL_FILE, HOT_URL);
+    for (int i = 0; i < READS; i++) {
+      h->add(new CacheHotReadTest(SMALL_FILE, i + 2 > cache_config_hot_objects_min_hits));
+    }
+    // A new version of the document is read from the volume again.
+    h->add(new CacheTestHandler(SMALL_FILE, HOT_URL));
+    h->add(new CacheHotReadTest(SMALL_FILE, false));
+    h->add(new TerminalTest);
+    this_ethread()->schedule_imm(h);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache hot objects", "cache")
+{
+  init_cache(256 * 1024 * 1024);
+  cache_config_hot_objects_entries  = 64;
+  cache_config_hot_objects_min_hits = 2;
+  CacheHotObjectsInit *init         = new CacheHotObjectsInit;
+
+  this_ethread()->schedule_imm(init);
+  this_ethread()->execute();
+  CHECK(hot_reads == READS - 1);
+}
@@ -0,0 +1,178 @@
+/** @file
+
+  Trace driven simulation of the RAM cache replacement algorithms.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// The trace is read from the file named by RAM_CACHE_TRACE, one request per line as "<key> <bytes>",
+// e.g. the cache key or URL and the object size from an access log. Without a trace a synthetic
+// zipf workload interleaved with scans of one-time objects is used.
+
+#include "main.h"
+
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#define SYNTHETIC_OBJECTS 20000
+#define SYNTHETIC_REQUESTS 400000
+#define SYNTHETIC_SCAN_EVERY 4 // one request in this many is part of a scan
+#define ZIPF_ALPHA 0.9
+
+namespace
+{
+struct Request {
+  CryptoHash key;
+  uint32_t bytes;
+};
+
+std::vector<Request> trace;
+int64_t working_set = 0; // bytes of the distinct objects in the trace
+
+void
+add_request(const CryptoHash &key, uint32_t bytes, std::unordered_map<uint64_t, uint32_t> &seen)
+{
+  trace.push_back({key, bytes});
+  if (seen.emplace(key.fold(), bytes).second) {
+    working_set += bytes;
+  }
+}
+
+bool
+load_trace(const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  if (fp == nullptr) {
+    return false;
+  }
+  std::unordered_map<uint64_t, uint32_t> seen;
+  char line[4096];
+  while (fgets(line, sizeof(line), fp)) {
+    char *sep = strrchr(line, ' ');
+    if (sep == nullptr || sep == line) {
+      continue;
+    }
+    CryptoHash key;
+    CryptoContext().hash_immediate(key, line, sep - line);
+    add_request(key, static_cast<uint32_t>(strtoul(sep + 1, nullptr, 10)), seen);
+  }
+  fclose(fp);
+  return !trace.empty();
+}
+
+void
+build_synthetic_trace()
+{
+  std::unordered_map<uint64_t, uint32_t> seen;
+  std::vector<double> cdf(SYNTHETIC_OBJECTS);
+  double total = 0;
+  for (int i = 0; i < SYNTHETIC_OBJECTS; i++) {
+    total += 1.0 / pow(i + 1, ZIPF_ALPHA);
+    cdf[i] = total;
+  }
+  srand48(13);
+  uint64_t scan = 0;
+  for (int i = 0; i < SYNTHETIC_REQUESTS; i++) {
+    uint64_t seed[2];
+    if (i % SYNTHETIC_SCAN_EVERY == 0) {
+      seed[0] = 1;
+      seed[1] = scan++;
+    } else {
+      seed[0] = 0;
+      seed[1] = std::lower_bound(cdf.begin(), cdf.end(), drand48() * total) - cdf.begin();
+    }
+    CryptoHash key;
+    CryptoContext().hash_immediate(key, seed, sizeof(seed));
+    // Sizes from 1KB to 64KB, fixed per object.
+    add_request(key, 1024 << (key.slice32(0) % 7), seen);
+  }
+}
+
+// The caches only look at the block size of the data, so one buffer of each size is shared.
+IOBufferData *
+buffer_for(uint32_t bytes)
+{
+  static Ptr<IOBufferData> buffers[DEFAULT_BUFFER_SIZES];
+  int64_t index = iobuffer_size_to_index(bytes, MAX_BUFFER_SIZE_INDEX);
+  if (!buffers[index]) {
+    buffers[index] = make_ptr(new_IOBufferData(index));
+  }
+  return buffers[index].get();
+}
+
+void
+simulate(RamCache *cache, const char *name, int64_t size, Vol *vol)
+{
+  uint64_t hits = 0, hit_bytes = 0, bytes = 0;
+
+  cache->init(size, vol);
+  ink_hrtime start = Thread::get_hrtime_updated();
+  for (auto &r : trace) {
+    Ptr<IOBufferData> data;
+    bytes += r.bytes;
+    if (cache->get(&r.key, &data)) {
+      hits++;
+      hit_bytes += r.bytes;
+    } else {
+      cache->put(&r.key, buffer_for(r.bytes), r.bytes);
+    }
+  }
+  double seconds = static_cast<double>(Thread::get_hrtime_updated() - start) / HRTIME_SECOND;
+  printf("%-8s %10" PRId64 " KB: hit rate %6.2f%%, byte hit rate %6.2f%%, %.0f requests/s\n", name, size >> 10,
+         100.0 * hits / trace.size(), 100.0 * hit_bytes / bytes, trace.size() / seconds);
+  CHECK(hits > 0);
+  delete cache;
+}
+} // namespace
+
+class RamCacheSimulation : public CacheInit
+{
+public:
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    const char *path = getenv("RAM_CACHE_TRACE");
+    if (path == nullptr || !load_trace(path)) {
+      build_synthetic_trace();
+    }
+    printf("%zu requests, working set %" PRId64 " KB, seen filter %s\n", trace.size(), working_set >> 10,
+           cache_config_ram_cache_use_seen_filter ? "on" : "off");
+
+    for (int percent : {1, 5, 20}) {
+      int64_t size = working_set * percent / 100;
+      simulate(new_RamCacheLRU(), "LRU", size, gvol[0]);
+      simulate(new_RamCacheCLFUS(), "CLFUS", size, gvol[0]);
+      simulate(new_RamCacheTinyLFU(), "TinyLFU", size, gvol[0]);
+    }
+
+    TEST_DONE();
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("RAM cache simulation", "cache")
+{
+  init_cache(256 * 1024 * 1024);
+  RamCacheSimulation *init = new RamCacheSimulation;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
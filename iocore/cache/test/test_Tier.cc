@@ -0,0 +1,139 @@
+/** @file
+
+  A document read often from the HDD tier is promoted to the SSD tier.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#define SMALL_FILE 10 * 1024
+#define TIER_URL "http://www.scw33.com/"
+#define PROMOTE_WAIT_MSEC 10
+#define PROMOTE_WAIT_RETRIES 500
+
+bool promoted = false;
+
+class CacheTierReadTest : public CacheTestHandler
+{
+public:
+  CacheTierReadTest(size_t size, int expect_tier) : _expect_tier(expect_tier)
+  {
+    this->_rt        = new CacheReadTest(size, this, TIER_URL);
+    this->_rt->mutex = this->mutex;
+    SET_HANDLER(&CacheTierReadTest::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    this_ethread()->schedule_imm(this->_rt);
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      CHECK(base->vc->vol->cache_vol->tier == _expect_tier);
+      base->do_io_read();
+      break;
+    case VC_EVENT_READ_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_READ_COMPLETE:
+      base->close();
+      delete this;
+      break;
+    default:
+      REQUIRE(false);
+      base->close();
+      delete this;
+      break;
+    }
+  }
+
+private:
+  int _expect_tier;
+};
+
+// Waits for the move started by the last read to commit.
+class CacheTierWait : public TestContChain
+{
+public:
+  CacheTierWait()
+  {
+    HTTPInfo info;
+    info.create();
+    build_hdrs(info, TIER_URL);
+    _key = generate_key(info).hash;
+    info.destroy();
+    SET_HANDLER(&CacheTierWait::wait_event);
+  }
+
+  int
+  wait_event(int event, void *e)
+  {
+    Vol *ssd = theCache->key_to_tier_vol(&_key, nullptr, 0, CACHE_TIER_SSD);
+    REQUIRE(ssd != nullptr);
+    if (dir_probe_miss(&_key, ssd) && ++_retries < PROMOTE_WAIT_RETRIES) {
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(PROMOTE_WAIT_MSEC));
+      return 0;
+    }
+    promoted = !dir_probe_miss(&_key, ssd);
+    delete this;
+    return 0;
+  }
+
+private:
+  CacheKey _key;
+  int _retries = 0;
+};
+
+class CacheTierInit : public CacheInit
+{
+public:
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    // The write and its read are the first read of the key.
+    CacheTestHandler *h = new CacheTestHandler(SMALL_FILE, TIER_URL);
+    h->add(new CacheTierReadTest(SMALL_FILE, CACHE_TIER_HDD));
+    h->add(new CacheTierWait);
+    h->add(new CacheTierReadTest(SMALL_FILE, CACHE_TIER_SSD));
+    h->add(new TerminalTest);
+    this_ethread()->schedule_imm(h);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache tier promotion", "cache")
+{
+  // Two volumes on the span of the other tests, the second one is the SSD tier.
+  Layout::get()->sysconfdir = std::string(TS_ABS_TOP_SRCDIR) + "/iocore/cache/test/tier";
+  init_cache(512 * 1024 * 1024);
+  cache_config_tier_promote_hits = 2;
+  CacheTierInit *init            = new CacheTierInit;
+
+  this_ethread()->schedule_imm(init);
+  this_ethread()->execute();
+  CHECK(promoted);
+}
@@ -27,6 +27,7 @@
 #include "tscore/ink_platform.h"
 #include "tscore/ink_rand.h"
 #include "tscore/I_Version.h"
+#include "tscore/StealQueue.h"
 #include "I_Thread.h"
 #include "I_PriorityEventQueue.h"
 #include "I_ProtectedQueue.h"
@@ -39,8 +40,12 @@
 // instead.
 #define MUTEX_RETRY_DELAY HRTIME_MSECONDS(20)
 
+// Immediate events a thread of a work stealing group holds for others to take, the rest it runs itself.
+#define STEAL_QUEUE_SIZE 1024
+
 struct DiskHandler;
 struct EventIO;
+struct RecRawStatBlock;
 
 class ServerSessionPool;
 class Event;
@@ -93,6 +98,7 @@ public:
   public:
     /** Called at the end of the event loop to block.
         @a timeout is the maximum length of time (in ns) to block.
+        @return The number of I/O events and signals found, 0 if it timed out.
     */
     virtual int waitForActivity(ink_hrtime timeout) = 0;
     /** Unblock.
@@ -326,6 +332,8 @@ public:
   void process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_count);
   void process_event(Event *e, int calling_code);
   void free_event(Event *e);
+  int process_stealable();
+  void process_taken(Event *e);
   LoopTailHandler *tail_cb = &DEFAULT_TAIL_HANDLER;
 
 #if HAVE_EVENTFD
@@ -348,36 +356,37 @@ public:
 
   ServerSessionPool *server_session_pool = nullptr;
 
+  /** Immediate events scheduled on the group of this thread, if the group does work stealing.
+
+      The thread puts these here instead of running them from its queues, then runs them from here
+      while idle threads of the group take them from the other end.
+      @see EventProcessor::ThreadGroupDescriptor::_steal
+  */
+  StealQueue<Event, STEAL_QUEUE_SIZE> *steal_queue = nullptr;
+  EventType steal_group   = 0; ///< The group whose threads take from each other.
+  unsigned int steal_next = 0; ///< Index in the group of the next thread to steal from or to wake.
+
+  /** Poll without blocking for this long after the thread last found work, 0 to always block when idle.
+      This trades CPU for the latency of waking up, for threads whose tail handler polls for I/O.
+  */
+  ink_hrtime busy_poll_time = 0;
+
   /** Default handler used until it is overridden.
 
-      This uses the cond var wait in @a ExternalQueue.
+      This waits on the event fd of the thread, or the cond var in @a EventQueueExternal where there is no eventfd.
   */
   class DefaultTailHandler : public LoopTailHandler
   {
     // cppcheck-suppress noExplicitConstructor; allow implicit conversion
-    DefaultTailHandler(ProtectedQueue &q) : _q(q) {}
-
-    int
-    waitForActivity(ink_hrtime timeout) override
-    {
-      _q.wait(Thread::get_hrtime() + timeout);
-      return 0;
-    }
-    void
-    signalActivity() override
-    {
-      /* Try to acquire the `EThread::lock` of the Event Thread:
-       *   - Acquired, indicating that the Event Thread is sleep,
-       *               must send a wakeup signal to the Event Thread.
-       *   - Failed, indicating that the Event Thread is busy, do nothing.
-       */
-      (void)_q.try_signal();
-    }
-
-    ProtectedQueue &_q;
+    DefaultTailHandler(EThread &t) : _t(t) {}
+
+    int waitForActivity(ink_hrtime timeout) override;
+    void signalActivity() override;
+
+    EThread &_t;
 
     friend class EThread;
-  } DEFAULT_TAIL_HANDLER = EventQueueExternal;
+  } DEFAULT_TAIL_HANDLER = *this;
 
   /// Statistics data for event dispatching.
   struct EventMetrics {
@@ -440,6 +449,25 @@ public:
   /// # of samples for each time scale.
   static int const SAMPLE_COUNT[N_EVENT_TIMESCALES];
 
+  /// Work stealing stats, plain counters kept per thread.
+  enum STEAL_STAT_ID {
+    STEAL_STAT_STEALS,  ///< # of events taken from another thread of the group.
+    STEAL_STAT_WAKEUPS, ///< # of times a thread with a backlog woke another thread of the group.
+    N_STEAL_STATS
+  };
+
+  static RecRawStatBlock *steal_rsb;
+
+  /// Busy polling stats, plain counters kept per thread.
+  enum BUSY_POLL_STAT_ID {
+    BUSY_POLL_STAT_SPIN_TIME, ///< Time spent in loops which polled without blocking and found nothing.
+    BUSY_POLL_STAT_WORK_TIME, ///< Time spent in loops which found work, on busy polling threads.
+    BUSY_POLL_STAT_HITS,      ///< # of polls without blocking that found work.
+    N_BUSY_POLL_STATS
+  };
+
+  static RecRawStatBlock *busy_poll_rsb;
+
   /// Process the last 1000s of data and write out the summaries to @a summary.
   void summarize_stats(EventMetrics summary[N_EVENT_TIMESCALES]);
   /// Back up the metric pointer, wrapping as needed.
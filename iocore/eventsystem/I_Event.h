@@ -209,6 +209,7 @@ public:
   unsigned int immediate : 1;
   unsigned int globally_allocated : 1;
   unsigned int in_heap : 4;
+  unsigned int stealable : 1; ///< Any thread of a work stealing group may run this, see @c EventProcessor::schedule.
   int callback_event = 0;
 
   ink_hrtime timeout_at = 0;
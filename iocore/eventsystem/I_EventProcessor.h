@@ -305,6 +305,9 @@ public:
     Que(Event, link) _spawnQueue;                    ///< Events to dispatch when thread is spawned.
     EThread *_thread[MAX_THREADS_IN_EACH_TYPE] = {}; ///< The actual threads in this group.
     std::function<void()> _afterStartCallback  = nullptr;
+    /// Idle threads run immediate events scheduled on busy threads of this group.
+    /// Set before the group is spawned, only for groups whose events do not need to stay on a thread.
+    bool _steal = false;
   };
 
   /// Storage for per group data.
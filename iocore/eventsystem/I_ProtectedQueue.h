@@ -25,31 +25,46 @@
 
   Protected Queue, a FIFO queue with the following functionality:
   (1). Multiple threads could be simultaneously trying to enqueue
-       and dequeue. Hence the queue needs to be protected with mutex.
-  (2). In case the queue is empty, dequeue() sleeps for a specified
-       amount of time, or until a new element is inserted, whichever
-       is earlier
+       while the owning thread dequeues. Enqueueing is lock free.
+  (2). The owning thread sleeps in its tail handler when it has nothing
+       to do. Only the first event enqueued since it went to sleep wakes
+       it up, a burst of events from other threads costs one signal, and
+       none at all while the owning thread is running.
 
 
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
+
 #include "tscore/ink_platform.h"
+#include "tscore/MPSCQueue.h"
 #include "I_Event.h"
 struct ProtectedQueue {
   void enqueue(Event *e);
-  void signal();
-  int try_signal();             // Use non blocking lock and if acquired, signal
   void enqueue_local(Event *e); // Safe when called from the same thread
-  void remove(Event *e);
   Event *dequeue_local();
-  void dequeue_external();       // Dequeue any external events.
+  void dequeue_external(); // Dequeue any external events.
+
+  /// Called by the owning thread before it blocks, return @c false if events arrived and it should not block.
+  bool prepare_wait();
+  /// Called by the owning thread after it blocked.
+  void end_wait();
+  /// Return @c true if the caller has to wake up the owning thread, which is then marked as awake.
+  bool claim_wakeup();
+
+#if !HAVE_EVENTFD
+  int try_signal();              // Use non blocking lock and if acquired, signal
   void wait(ink_hrtime timeout); // Wait for @a timeout nanoseconds on a condition variable if there are no events.
 
-  InkAtomicList al;
   ink_mutex lock;
   ink_cond might_have_data;
+#endif
+
+  MPSCQueue<Event> externalQueue;
   Que(Event, link) localQueue;
+  /// Whether the owning thread is running, cleared while it blocks.
+  std::atomic<bool> awake{true};
 
   ProtectedQueue();
 };
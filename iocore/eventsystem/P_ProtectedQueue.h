@@ -34,21 +34,13 @@
 TS_INLINE
 ProtectedQueue::ProtectedQueue()
 {
-  Event e;
+#if !HAVE_EVENTFD
   ink_mutex_init(&lock);
-  ink_atomiclist_init(&al, "ProtectedQueue", (char *)&e.link.next - (char *)&e);
   ink_cond_init(&might_have_data);
+#endif
 }
 
-TS_INLINE void
-ProtectedQueue::signal()
-{
-  // Need to get the lock before you can signal the thread
-  ink_mutex_acquire(&lock);
-  ink_cond_signal(&might_have_data);
-  ink_mutex_release(&lock);
-}
-
+#if !HAVE_EVENTFD
 TS_INLINE int
 ProtectedQueue::try_signal()
 {
@@ -61,6 +53,33 @@ ProtectedQueue::try_signal()
     return 0;
   }
 }
+#endif
+
+TS_INLINE bool
+ProtectedQueue::prepare_wait()
+{
+  // Producers which push after this see the thread asleep and wake it, the ones which pushed before
+  // are seen here.
+  awake.store(false);
+  if (externalQueue.empty()) {
+    return true;
+  }
+  awake.store(true, std::memory_order_relaxed);
+  return false;
+}
+
+TS_INLINE void
+ProtectedQueue::end_wait()
+{
+  awake.store(true, std::memory_order_relaxed);
+}
+
+TS_INLINE bool
+ProtectedQueue::claim_wakeup()
+{
+  // Checked first so a burst of producers does not fight over the cache line while the thread is running.
+  return !awake.load() && !awake.exchange(true);
+}
 
 // Called from the same thread (don't need to signal)
 TS_INLINE void
@@ -71,16 +90,6 @@ ProtectedQueue::enqueue_local(Event *e)
   localQueue.enqueue(e);
 }
 
-TS_INLINE void
-ProtectedQueue::remove(Event *e)
-{
-  ink_assert(e->in_the_prot_queue);
-  if (!ink_atomiclist_remove(&al, e)) {
-    localQueue.remove(e);
-  }
-  e->in_the_prot_queue = 0;
-}
-
 TS_INLINE Event *
 ProtectedQueue::dequeue_local()
 {
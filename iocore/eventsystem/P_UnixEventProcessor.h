@@ -116,6 +116,8 @@ EventProcessor::schedule(Event *e, EventType etype)
   if (e->continuation->mutex) {
     e->mutex = e->continuation->mutex;
   }
+  // Scheduled on the group rather than a thread, so any thread of the group will do.
+  e->stealable = thread_group[etype]._steal;
 
   if (curr_thread != nullptr && e->ethread == curr_thread) {
     e->ethread->EventQueueExternal.enqueue_local(e);
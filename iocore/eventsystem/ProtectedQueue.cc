@@ -32,15 +32,6 @@
 
 #include "P_EventSystem.h"
 
-// The protected queue is designed to delay signaling of threads
-// until some amount of work has been completed on the current thread
-// in order to prevent excess context switches.
-//
-// Defining EAGER_SIGNALLING disables this behavior and causes
-// threads to be made runnable immediately.
-//
-// #define EAGER_SIGNALLING
-
 extern ClassAllocator<Event> eventAllocator;
 
 void
@@ -49,30 +40,20 @@ ProtectedQueue::enqueue(Event *e)
   ink_assert(!e->in_the_prot_queue && !e->in_the_priority_queue);
   EThread *e_ethread   = e->ethread;
   e->in_the_prot_queue = 1;
-  bool was_empty       = (ink_atomiclist_push(&al, e) == nullptr);
+  externalQueue.push(e);
 
-  if (was_empty) {
-    EThread *inserting_thread = this_ethread();
-    // queue e->ethread in the list of threads to be signalled
-    // inserting_thread == 0 means it is not a regular EThread
-    if (inserting_thread != e_ethread) {
-      e_ethread->tail_cb->signalActivity();
-    }
+  // A thread enqueueing for itself is awake, otherwise only the first event since the thread went
+  // to sleep signals it.
+  if (this_ethread() != e_ethread && claim_wakeup()) {
+    e_ethread->tail_cb->signalActivity();
   }
 }
 
 void
 ProtectedQueue::dequeue_external()
 {
-  Event *e = static_cast<Event *>(ink_atomiclist_popall(&al));
-  // invert the list, to preserve order
-  SLL<Event, Event::Link_link> l, t;
-  t.head = e;
-  while ((e = t.pop())) {
-    l.push(e);
-  }
-  // insert into localQueue
-  while ((e = l.pop())) {
+  Event *e;
+  while ((e = externalQueue.pop())) {
     if (!e->cancelled) {
       localQueue.enqueue(e);
     } else {
@@ -82,6 +63,7 @@ ProtectedQueue::dequeue_external()
   }
 }
 
+#if !HAVE_EVENTFD
 void
 ProtectedQueue::wait(ink_hrtime timeout)
 {
@@ -91,8 +73,9 @@ ProtectedQueue::wait(ink_hrtime timeout)
    *   - And then the Event Thread goes to sleep and waits for the wakeup signal of `EThread::might_have_data`,
    *   - The `EThread::lock` will be locked again when the Event Thread wakes up.
    */
-  if (INK_ATOMICLIST_EMPTY(al) && localQueue.empty()) {
+  if (externalQueue.empty() && localQueue.empty()) {
     timespec ts = ink_hrtime_to_timespec(timeout);
     ink_cond_timedwait(&might_have_data, &lock, &ts);
   }
 }
+#endif
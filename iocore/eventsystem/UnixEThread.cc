@@ -31,6 +31,7 @@
 #include "P_EventSystem.h"
 
 #if HAVE_EVENTFD
+#include <poll.h>
 #include <sys/eventfd.h>
 #endif
 
@@ -49,6 +50,9 @@ char const *const EThread::STAT_NAME[] = {"proxy.process.eventloop.count",
 
 int const EThread::SAMPLE_COUNT[N_EVENT_TIMESCALES] = {10, 100, 1000};
 
+RecRawStatBlock *EThread::steal_rsb     = nullptr;
+RecRawStatBlock *EThread::busy_poll_rsb = nullptr;
+
 int thread_max_heartbeat_mseconds = THREAD_MAX_HEARTBEAT_MSECONDS;
 
 EThread::EThread()
@@ -92,7 +96,46 @@ EThread::EThread(ThreadType att, Event *e) : tt(att), start_event(e)
 
 // Provide a destructor so that SDK functions which create and destroy
 // threads won't have to deal with EThread memory deallocation.
-EThread::~EThread() {}
+EThread::~EThread()
+{
+  delete steal_queue;
+}
+
+int
+EThread::DefaultTailHandler::waitForActivity(ink_hrtime timeout)
+{
+#if HAVE_EVENTFD
+  // The event fd is only written to while this thread sleeps, see ProtectedQueue::claim_wakeup().
+  if (timeout > 0) {
+    struct pollfd pfd = {_t.evfd, POLLIN, 0};
+    timespec ts       = ink_hrtime_to_timespec(timeout);
+    if (ppoll(&pfd, 1, &ts, nullptr) > 0) {
+      uint64_t counter;
+      ATS_UNUSED_RETURN(read(_t.evfd, &counter, sizeof(uint64_t)));
+      return 1;
+    }
+  }
+#else
+  _t.EventQueueExternal.wait(Thread::get_hrtime() + timeout);
+#endif
+  return 0;
+}
+
+void
+EThread::DefaultTailHandler::signalActivity()
+{
+#if HAVE_EVENTFD
+  uint64_t counter = 1;
+  ATS_UNUSED_RETURN(write(_t.evfd, &counter, sizeof(uint64_t)));
+#else
+  /* Try to acquire the `EThread::lock` of the Event Thread:
+   *   - Acquired, indicating that the Event Thread is sleep,
+   *               must send a wakeup signal to the Event Thread.
+   *   - Failed, indicating that the Event Thread is busy, do nothing.
+   */
+  (void)_t.EventQueueExternal.try_signal();
+#endif
+}
 
 bool
 EThread::is_event_type(EventType et)
@@ -159,7 +202,16 @@ EThread::process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_
       free_event(e);
     } else if (!e->timeout_at) { // IMMEDIATE
       ink_assert(e->period == 0);
-      process_event(e, e->callback_event);
+      if (e->stealable && steal_queue) {
+        // Still in the queue as far as rescheduling goes until someone takes it.
+        e->in_the_prot_queue = 1;
+        if (!steal_queue->push(e)) {
+          e->in_the_prot_queue = 0;
+          process_event(e, e->callback_event);
+        }
+      } else {
+        process_event(e, e->callback_event);
+      }
     } else if (e->timeout_at > 0) { // INTERVAL
       EventQueue.enqueue(e, cur_time);
     } else { // NEGATIVE
@@ -174,9 +226,65 @@ EThread::process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_
       } else {
         NegativeQueue->insert(e, p);
       }
+      ++(*nq_count);
+    }
+  }
+}
+
+void
+EThread::process_taken(Event *e)
+{
+  e->ethread           = this;
+  e->in_the_prot_queue = 0;
+  if (e->cancelled) {
+    free_event(e);
+  } else {
+    process_event(e, e->callback_event);
+  }
+}
+
+// Run the events in the steal queue of this thread, waking another thread of the group to help if
+// there is a backlog. Then take events from the other threads until they have none left or this
+// thread has work of its own again. Return the number of events taken from other threads.
+int
+EThread::process_stealable()
+{
+  EventProcessor::ThreadGroupDescriptor &tg = eventProcessor.thread_group[steal_group];
+  int stolen                                = 0;
+  bool woke                                 = false;
+  Event *e;
+
+  while ((e = steal_queue->take())) {
+    if (!woke && !steal_queue->empty() && tg._count > 1) {
+      EThread *t = tg._thread[steal_next++ % tg._count];
+      if (t == this) {
+        t = tg._thread[steal_next++ % tg._count];
+      }
+      if (t->EventQueueExternal.claim_wakeup()) {
+        t->tail_cb->signalActivity();
+        RecIncrRawStat(steal_rsb, this, STEAL_STAT_WAKEUPS, 1);
+      }
+      woke = true;
     }
-    ++(*nq_count);
+    process_taken(e);
   }
+
+  auto idle = [this]() { return EventQueueExternal.localQueue.empty() && EventQueueExternal.externalQueue.empty(); };
+  for (int misses = 0; misses < tg._count && idle();) {
+    EThread *t = tg._thread[steal_next++ % tg._count];
+    if (t == this || t->steal_queue == nullptr || (e = t->steal_queue->take()) == nullptr) {
+      ++misses;
+      continue;
+    }
+    // There may be more behind it, keep stealing from this thread.
+    --steal_next;
+    misses = 0;
+    RecIncrRawStat(steal_rsb, this, STEAL_STAT_STEALS, 1);
+    process_taken(e);
+    ++stolen;
+  }
+
+  return stolen;
 }
 
 void
@@ -194,6 +302,7 @@ EThread::execute_regular()
 
   int nq_count;
   int ev_count;
+  ink_hrtime busy_poll_until = 0; // Poll without blocking until then.
 
   // A statically initialized instance we can use as a prototype for initializing other instances.
   static EventMetrics METRIC_INIT;
@@ -248,9 +357,17 @@ EThread::execute_regular()
       }
     }
 
+    // Events taken from other threads may have left work behind, check again before sleeping.
+    int stolen = 0;
+    if (steal_queue) {
+      stolen = process_stealable();
+      ev_count += stolen;
+    }
+
     next_time             = EventQueue.earliest_timeout();
     ink_hrtime sleep_time = next_time - Thread::get_hrtime_updated();
-    if (sleep_time > 0) {
+    bool spinning         = busy_poll_time > 0 && Thread::get_hrtime() < busy_poll_until;
+    if (sleep_time > 0 && !stolen && !spinning) {
       if (EventQueueExternal.localQueue.empty()) {
         sleep_time = std::min(sleep_time, HRTIME_MSECONDS(thread_max_heartbeat_mseconds));
       } else {
@@ -263,12 +380,32 @@ EThread::execute_regular()
       sleep_time = 0;
     }
 
-    tail_cb->waitForActivity(sleep_time);
+    // Other threads wake this one up only if they see it asleep, and it does not sleep if they pushed events before.
+    if (sleep_time > 0 && !EventQueueExternal.prepare_wait()) {
+      sleep_time = 0;
+    }
+    int activity = tail_cb->waitForActivity(sleep_time);
+    if (sleep_time > 0) {
+      EventQueueExternal.end_wait();
+    }
 
     // loop cleanup
     loop_finish_time = Thread::get_hrtime_updated();
     delta            = loop_finish_time - loop_start_time;
 
+    // Keep polling without blocking for a while after finding work, in case more comes right behind it.
+    if (busy_poll_time > 0) {
+      if (activity > 0 || ev_count > nq_count) {
+        busy_poll_until = loop_finish_time + busy_poll_time;
+        RecIncrRawStat(busy_poll_rsb, this, BUSY_POLL_STAT_WORK_TIME, delta);
+        if (spinning) {
+          RecIncrRawStat(busy_poll_rsb, this, BUSY_POLL_STAT_HITS, 1);
+        }
+      } else if (spinning) {
+        RecIncrRawStat(busy_poll_rsb, this, BUSY_POLL_STAT_SPIN_TIME, delta);
+      }
+    }
+
     // This can happen due to time of day adjustments (which apparently happen quite frequently). I
     // tried using the monotonic clock to get around this but it was *very* stuttery (up to hundreds
     // of milliseconds), far too much to be actually used.
@@ -316,6 +453,7 @@ EThread::execute()
 
   switch (tt) {
   case REGULAR: {
+#if !HAVE_EVENTFD
     /* The Event Thread has two status: busy and sleep:
      *   - Keep `EThread::lock` locked while Event Thread is busy,
      *   - The `EThread::lock` is released while Event Thread is sleep.
@@ -324,8 +462,11 @@ EThread::execute()
      *   - Failed, indicating that the target Event Thread is busy.
      */
     ink_mutex_acquire(&EventQueueExternal.lock);
+#endif
     this->execute_regular();
+#if !HAVE_EVENTFD
     ink_mutex_release(&EventQueueExternal.lock);
+#endif
     break;
   }
   case DEDICATED: {
@@ -200,6 +200,11 @@ ThreadAffinityInitializer::set_affinity(int, Event *)
     Debug("iocore_thread", "EThread: %d %s: %d", _name, obj->logical_index);
 #endif // HWLOC_API_VERSION
     hwloc_set_thread_cpubind(ink_get_topology(), t->tid, obj->cpuset, HWLOC_CPUBIND_STRICT);
+    // A thread that runs on a single NUMA node takes its memory from that node's free lists.
+    if (hwloc_obj_t node = hwloc_get_next_obj_covering_cpuset_by_type(ink_get_topology(), obj->cpuset, HWLOC_OBJ_NODE, nullptr)) {
+      Debug("iocore_thread", "EThread: %p NUMA Node: %d", t, node->logical_index);
+      ink_freelist_set_thread_node(node->logical_index);
+    }
   } else {
     Warning("hwloc returned an unexpected number of objects -- CPU affinity disabled");
   }
@@ -377,6 +382,10 @@ EventProcessor::spawn_event_threads(EventType ev_type, int n_threads, size_t sta
     t->id                        = i; // unfortunately needed to support affinity and NUMA logic.
     t->set_event_type(ev_type);
     t->schedule_spawn(&thread_initializer);
+    if (tg->_steal) {
+      t->steal_queue = new StealQueue<Event, STEAL_QUEUE_SIZE>;
+      t->steal_group = ev_type;
+    }
   }
   tg->_count = n_threads;
   n_ethreads += n_threads;
@@ -452,6 +461,20 @@ EventProcessor::start(int n_event_threads, size_t stacksize)
   // Name must be that of a stat, pick one at random since we do all of them in one pass/callback.
   RecRegisterRawStatSyncCb(name, EventMetricStatSync, rsb, 0);
 
+  EThread::steal_rsb = RecAllocateRawStatBlock(EThread::N_STEAL_STATS);
+  RecRegisterRawStat(EThread::steal_rsb, RECT_PROCESS, "proxy.process.eventloop.steals", RECD_INT, RECP_NON_PERSISTENT,
+                     EThread::STEAL_STAT_STEALS, RecRawStatSyncSum);
+  RecRegisterRawStat(EThread::steal_rsb, RECT_PROCESS, "proxy.process.eventloop.steal_wakeups", RECD_INT, RECP_NON_PERSISTENT,
+                     EThread::STEAL_STAT_WAKEUPS, RecRawStatSyncSum);
+
+  EThread::busy_poll_rsb = RecAllocateRawStatBlock(EThread::N_BUSY_POLL_STATS);
+  RecRegisterRawStat(EThread::busy_poll_rsb, RECT_PROCESS, "proxy.process.eventloop.busy_poll.spin_time", RECD_INT,
+                     RECP_NON_PERSISTENT, EThread::BUSY_POLL_STAT_SPIN_TIME, RecRawStatSyncSum);
+  RecRegisterRawStat(EThread::busy_poll_rsb, RECT_PROCESS, "proxy.process.eventloop.busy_poll.work_time", RECD_INT,
+                     RECP_NON_PERSISTENT, EThread::BUSY_POLL_STAT_WORK_TIME, RecRawStatSyncSum);
+  RecRegisterRawStat(EThread::busy_poll_rsb, RECT_PROCESS, "proxy.process.eventloop.busy_poll.hits", RECD_INT, RECP_NON_PERSISTENT,
+                     EThread::BUSY_POLL_STAT_HITS, RecRawStatSyncSum);
+
   this->spawn_event_threads(ET_CALL, n_event_threads, stacksize);
 
   Debug("iocore_thread", "Created event thread group id %d with %d threads", ET_CALL, n_event_threads);
@@ -33,6 +33,73 @@
 #define TEST_TIME_SECOND 60
 #define TEST_THREADS 2
 
+// Runs before the event system is shut down by the next test.
+TEST_CASE("EventSystemWorkStealing", "[iocore]")
+{
+  static constexpr int N_EVENTS = 16;
+  static std::atomic<int> ran;
+  static std::atomic<int> ran_elsewhere;
+  static std::atomic<bool> done;
+  static EThread *blocked;
+  static EventType ET_STEAL;
+
+  struct worker : public Continuation {
+    worker() : Continuation(new_ProxyMutex()) { SET_HANDLER(&worker::work); }
+
+    int
+    work(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      if (this_ethread() != blocked) {
+        ++ran_elsewhere;
+      }
+      ++ran;
+      return 0;
+    }
+  };
+
+  // Queues the other events behind itself and holds its thread until another thread ran them.
+  struct blocker : public Continuation {
+    blocker() : Continuation(new_ProxyMutex()) { SET_HANDLER(&blocker::start); }
+
+    int
+    start(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      SET_HANDLER(&blocker::block);
+      eventProcessor.schedule_imm(this, ET_STEAL);
+      for (int i = 0; i < N_EVENTS; ++i) {
+        eventProcessor.schedule_imm(new worker, ET_STEAL);
+      }
+      return 0;
+    }
+
+    int
+    block(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      blocked = this_ethread();
+      for (int i = 0; i < 10000 && ran < N_EVENTS; ++i) {
+        usleep(1000);
+      }
+      done = true;
+      return 0;
+    }
+  };
+
+  ET_STEAL                                     = eventProcessor.register_event_type("ET_STEAL");
+  eventProcessor.thread_group[ET_STEAL]._steal = true;
+  eventProcessor.spawn_event_threads(ET_STEAL, 2, 1048576);
+  while (!eventProcessor.has_tg_started(ET_STEAL)) {
+    usleep(1000);
+  }
+
+  eventProcessor.schedule_imm(new blocker, ET_STEAL);
+  while (!done) {
+    usleep(1000);
+  }
+
+  CHECK(ran == N_EVENTS);
+  CHECK(ran_elsewhere == N_EVENTS);
+}
+
 TEST_CASE("EventSystem", "[iocore]")
 {
   static int count;
@@ -61,6 +61,12 @@ extern int net_accept_period;
 extern int net_retry_delay;
 extern int net_throttle_delay;
 
+extern int net_zero_copy_threshold;
+
+// In micro-seconds
+extern int net_config_busy_poll_usec;
+extern int net_config_sock_busy_poll_usec;
+
 extern std::string_view net_ccp_in;
 extern std::string_view net_ccp_out;
 
@@ -32,6 +32,12 @@
 #pragma once
 
 #include "I_UDPConnection.h"
+
+/// The most datagrams a packet of segments (see UDPPacketInternal::segment_size) may carry.
+constexpr int UDP_GSO_MAX_SEGMENTS = 64;
+/// The most bytes a packet of segments may carry.
+constexpr int UDP_GSO_MAX_BYTES = 65000;
+
 /** @name UDPPacket
     UDP packet functions used by UDPConnection
  */
@@ -40,6 +40,13 @@ int net_accept_period       = 10;
 int net_retry_delay         = 10;
 int net_throttle_delay      = 50; /* milliseconds */
 
+// Minimum write size, in bytes, sent with MSG_ZEROCOPY. 0 disables zero copy sends.
+int net_zero_copy_threshold = 0;
+
+// In micro-seconds, how long net threads and sockets poll for more I/O before they block. 0 disables busy polling.
+int net_config_busy_poll_usec      = 0;
+int net_config_sock_busy_poll_usec = 0;
+
 // For the in/out congestion control: ToDo: this probably would be better as ports: specifications
 std::string_view net_ccp_in;
 std::string_view net_ccp_out;
@@ -52,10 +59,24 @@ configure_net()
 
   REC_EstablishStaticConfigInt32(net_retry_delay, "proxy.config.net.retry_delay");
   REC_EstablishStaticConfigInt32(net_throttle_delay, "proxy.config.net.throttle_delay");
+  REC_EstablishStaticConfigInt32(net_zero_copy_threshold, "proxy.config.net.zero_copy_threshold");
 
   // These are not reloadable
   REC_ReadConfigInteger(net_event_period, "proxy.config.net.event_period");
   REC_ReadConfigInteger(net_accept_period, "proxy.config.net.accept_period");
+  REC_ReadConfigInteger(net_config_busy_poll_usec, "proxy.config.net.busy_poll_usec");
+  REC_ReadConfigInteger(net_config_sock_busy_poll_usec, "proxy.config.net.sock_busy_poll_usec");
+
+#if TS_USE_LINUX_IO_URING
+  REC_ReadConfigInteger(net_config_io_uring, "proxy.config.net.io_uring.enabled");
+  REC_ReadConfigInteger(net_config_io_uring_entries, "proxy.config.net.io_uring.entries");
+  REC_ReadConfigInteger(net_config_io_uring_buffers, "proxy.config.net.io_uring.buffers");
+  REC_ReadConfigInteger(net_config_io_uring_buffer_size, "proxy.config.net.io_uring.buffer_size");
+  if (net_config_io_uring) {
+    Note("Running with io_uring network I/O, %d entries and %d receive buffers per net thread", net_config_io_uring_entries,
+         net_config_io_uring_buffers);
+  }
+#endif
 
   // This is kinda fugly, but better than it was before (on every connection in and out)
   // Note that these would need to be ats_free()'d if we ever want to clean that up, but
@@ -90,11 +111,16 @@ register_net_stats()
     {"proxy.process.net.calls_to_writetonet", net_calls_to_writetonet_stat},
     {"proxy.process.net.calls_to_writetonet_afterpoll", net_calls_to_writetonet_afterpoll_stat},
     {"proxy.process.net.inactivity_cop_lock_acquire_failure", inactivity_cop_lock_acquire_failure_stat},
+    {"proxy.process.net.io_uring.completions", net_io_uring_completions_stat},
+    {"proxy.process.net.io_uring.submits", net_io_uring_submits_stat},
     {"proxy.process.net.net_handler_run", net_handler_run_stat},
     {"proxy.process.net.read_bytes", net_read_bytes_stat},
+    {"proxy.process.net.timeout_wheel_expired", net_timeout_wheel_expired_stat},
     {"proxy.process.net.write_bytes", net_write_bytes_stat},
     {"proxy.process.net.fastopen_out.attempts", net_fastopen_attempts_stat},
     {"proxy.process.net.fastopen_out.successes", net_fastopen_successes_stat},
+    {"proxy.process.net.zero_copy.bytes", net_zero_copy_bytes_stat},
+    {"proxy.process.net.zero_copy.copied", net_zero_copy_copied_stat},
     {"proxy.process.socks.connections_successful", socks_connections_successful_stat},
     {"proxy.process.socks.connections_unsuccessful", socks_connections_unsuccessful_stat},
   };
@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <algorithm>
+
+#include "tscore/TimerWheel.h"
 #include "I_EventSystem.h"
 
 class NetHandler;
@@ -74,9 +77,21 @@ public:
   ink_hrtime submit_time                = 0;
 
   bool default_inactivity_timeout = false;
+  int timeout_in_enabled_list     = 0;
+
+  // When the inactivity or active timeout is due, 0 if there is no timeout.
+  ink_hrtime
+  next_timeout_at() const
+  {
+    if (next_inactivity_timeout_at && next_activity_timeout_at) {
+      return std::min(next_inactivity_timeout_at, next_activity_timeout_at);
+    }
+    return next_inactivity_timeout_at ? next_inactivity_timeout_at : next_activity_timeout_at;
+  }
 
   LINK(NetEvent, open_link);
-  LINK(NetEvent, cop_link);
+  TimerWheelLink<NetEvent> timeout_link;
+  SLINK(NetEvent, timeout_enable_link);
   LINKM(NetEvent, read, ready_link)
   SLINKM(NetEvent, read, enable_link)
   LINKM(NetEvent, write, ready_link)
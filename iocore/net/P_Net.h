@@ -55,10 +55,15 @@ enum Net_Stats {
   default_inactivity_timeout_count_stat,
   net_fastopen_attempts_stat,
   net_fastopen_successes_stat,
+  net_zero_copy_bytes_stat,
+  net_zero_copy_copied_stat,
   net_tcp_accept_stat,
   net_connections_throttled_in_stat,
   net_connections_throttled_out_stat,
   net_requests_max_throttled_in_stat,
+  net_timeout_wheel_expired_stat,
+  net_io_uring_submits_stat,
+  net_io_uring_completions_stat,
   Net_Stat_Count
 };
 
@@ -43,6 +43,7 @@
 #include "P_Connection.h"
 
 struct NetAccept;
+struct NetAcceptSteering;
 class Event;
 class SSLNextProtocolAccept;
 //
@@ -89,6 +90,9 @@ struct NetAccept : public Continuation {
   Ptr<NetAcceptAction> action_;
   SSLNextProtocolAccept *snpa = nullptr;
   EventIO ep;
+  /// The CPU steering of the per thread listen sockets of the port, until it is set up.
+  NetAcceptSteering *steering = nullptr;
+  int steering_index          = -1; ///< The index of the listen socket in its SO_REUSEPORT group.
 
   HttpProxyPort *proxyPort = nullptr;
   NetProcessor::AcceptOptions opt;
@@ -107,6 +111,8 @@ struct NetAccept : public Continuation {
 
   virtual int acceptEvent(int event, void *e);
   virtual int acceptFastEvent(int event, void *e);
+  /// Set up a connection accepted on @a t and hand it to the acceptor.
+  void accept_connection(EThread *t, Connection &con);
   virtual int accept_per_thread(int event, void *e);
   int acceptLoopEvent(int event, Event *e);
   void cancel();
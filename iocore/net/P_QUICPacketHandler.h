@@ -42,14 +42,15 @@ public:
   ~QUICPacketHandler();
 
   void send_packet(const QUICPacket &packet, QUICNetVConnection *vc, const QUICPacketHeaderProtector &pn_protector);
-  void send_packet(QUICNetVConnection *vc, const Ptr<IOBufferBlock> &udp_payload);
+  /// Send @a udp_payload, a train of datagrams of @a segment_size bytes if it is not 0.
+  void send_packet(QUICNetVConnection *vc, const Ptr<IOBufferBlock> &udp_payload, uint16_t segment_size = 0);
 
   void close_connection(QUICNetVConnection *conn);
 
 protected:
   void _send_packet(const QUICPacket &packet, UDPConnection *udp_con, IpEndpoint &addr, uint32_t pmtu,
                     const QUICPacketHeaderProtector *ph_protector, int dcil);
-  void _send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload);
+  void _send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload, uint16_t segment_size = 0);
   QUICConnection *_check_stateless_reset(const uint8_t *buf, size_t buf_len);
 
   // FIXME Remove this
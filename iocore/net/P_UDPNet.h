@@ -61,6 +61,12 @@ extern UDPNetProcessorInternal udpNetInternal;
 constexpr int UDP_PERIOD    = 9;
 constexpr int UDP_NH_PERIOD = UDP_PERIOD + 1;
 
+// Datagrams read with one recvmmsg() and the size of the buffer of each, big enough for a GRO train.
+constexpr int UDP_RECV_BATCH    = 16;
+constexpr int UDP_RECV_BUF_SIZE = 65536;
+// Packets handed to one UDPQueue::SendMultipleUDPPackets() call.
+constexpr int UDP_SEND_BATCH = 32;
+
 class PacketQueue
 {
 public:
@@ -287,6 +293,13 @@ public:
 
   void SendPackets();
   void SendUDPPacket(UDPPacketInternal *p, int32_t pktLen);
+#if HAVE_SENDMMSG
+  /// Send @a n packets with as few sendmmsg() calls as possible.
+  void SendMultipleUDPPackets(UDPPacketInternal **p, int n);
+#endif
+
+  /// Whether packets of segments go out with UDP GSO, cleared when the kernel refuses it.
+  bool gso = true;
 
   // Interface exported to the outside world
   void send(UDPPacket *p);
@@ -316,6 +329,8 @@ public:
   EThread *thread      = nullptr;
   ink_hrtime nextCheck;
   ink_hrtime lastCheck;
+  /// UDP_RECV_BATCH buffers of UDP_RECV_BUF_SIZE bytes recvmmsg() reads into, allocated on first use.
+  char *recv_buf = nullptr;
 
   int startNetEvent(int event, Event *data);
   int mainNetEvent(int event, Event *data);
@@ -46,6 +46,9 @@ public:
 
   int reqGenerationNum     = 0;
   ink_hrtime delivery_time = 0; // when to deliver packet
+  /// When not 0 the chain is a train of datagrams of this size, the last one may be shorter. They are sent with
+  /// one call, using UDP GSO where the kernel supports it.
+  uint16_t segment_size = 0;
 
   Ptr<IOBufferBlock> chain;
   Continuation *cont          = nullptr; // callback on error
@@ -162,13 +165,14 @@ UDPPacket::getConnection()
 }
 
 TS_INLINE UDPPacket *
-new_UDPPacket(struct sockaddr const *to, ink_hrtime when, Ptr<IOBufferBlock> &buf)
+new_UDPPacket(struct sockaddr const *to, ink_hrtime when, Ptr<IOBufferBlock> &buf, uint16_t segment_size = 0)
 {
   UDPPacketInternal *p = udpPacketAllocator.alloc();
 
   p->in_the_priority_queue = 0;
   p->in_heap               = 0;
   p->delivery_time         = when;
+  p->segment_size          = segment_size;
   if (to)
     ats_ip_copy(&p->to, to);
   p->chain = buf;
@@ -183,6 +187,7 @@ new_incoming_UDPPacket(struct sockaddr *from, struct sockaddr *to, Ptr<IOBufferB
   p->in_the_priority_queue = 0;
   p->in_heap               = 0;
   p->delivery_time         = 0;
+  p->segment_size          = 0;
   ats_ip_copy(&p->from, from);
   ats_ip_copy(&p->to, to);
   p->chain = block;
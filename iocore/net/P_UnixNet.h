@@ -141,6 +141,7 @@ struct EventIO {
 #include "P_DNSConnection.h"
 #include "P_UnixUDPConnection.h"
 #include "P_UnixPollDescriptor.h"
+#include "P_UnixNetUring.h"
 #include <limits>
 
 class NetEvent;
@@ -265,9 +266,13 @@ public:
   QueM(NetEvent, NetState, read, ready_link) read_ready_list;
   QueM(NetEvent, NetState, write, ready_link) write_ready_list;
   Que(NetEvent, open_link) open_list;
-  DList(NetEvent, cop_link) cop_list;
   ASLLM(NetEvent, NetState, read, enable_link) read_enable_list;
   ASLLM(NetEvent, NetState, write, enable_link) write_enable_list;
+  TimerWheel<NetEvent, &NetEvent::timeout_link> timeout_wheel; ///< NetEvents of the open_list, by next timeout
+  ASLL(NetEvent, timeout_enable_link) timeout_enable_list;
+#if TS_USE_LINUX_IO_URING
+  NetUring *uring = nullptr; ///< Set when the network I/O of this thread goes through io_uring.
+#endif
   Que(NetEvent, keep_alive_queue_link) keep_alive_queue;
   uint32_t keep_alive_queue_size = 0;
   Que(NetEvent, active_queue_link) active_queue;
@@ -321,6 +326,7 @@ public:
   int waitForActivity(ink_hrtime timeout) override;
   void process_enabled_list();
   void process_ready_list();
+  void process_timeouts();
   void manage_keep_alive_queue();
   bool manage_active_queue(NetEvent *ne, bool ignore_queue_size);
   void add_to_keep_alive_queue(NetEvent *ne);
@@ -355,21 +361,29 @@ public:
 
   /**
     Start to handle active timeout and inactivity timeout on a NetEvent.
-    Put the ne into open_list. All NetEvents in the open_list is checked for timeout by InactivityCop.
+    Put the ne into open_list and timeout_wheel, the NetEvents are checked for timeout when they are due.
     Only be called when holding the mutex of this NetHandler and must call startIO(ne) first.
 
-    @param ne NetEvent to be managed by InactivityCop
+    @param ne NetEvent to be managed by the timeout wheel
    */
   void startCop(NetEvent *ne);
   /**
     Stop to handle active timeout and inactivity on a NetEvent.
-    Remove the ne from open_list and cop_list.
+    Remove the ne from open_list and timeout_wheel.
     Also remove the ne from keep_alive_queue and active_queue if its context is IN.
     Only be called when holding the mutex of this NetHandler.
 
     @param ne NetEvent to be released.
    */
   void stopCop(NetEvent *ne);
+  /**
+    Move ne in the timeout_wheel after its timeouts changed.
+    Earlier timeouts take effect at once, later ones when the earlier time is due.
+    May be called from any thread holding the mutex of ne.
+
+    @param ne NetEvent whose timeouts changed.
+   */
+  void update_timeout(NetEvent *ne);
 
   // Signal the epoll_wait to terminate.
   void signalActivity() override;
@@ -385,6 +399,8 @@ public:
 
 private:
   void _close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &closed, int &total_idle_time, int &total_idle_count);
+  void _schedule_timeout(NetEvent *ne, ink_hrtime now);
+  void _timeout_expired(NetEvent *ne, ink_hrtime now);
 
   /// Static method used as the callback for runtime configuration updates.
   static int update_nethandler_config(const char *name, RecDataT, RecData data, void *);
@@ -883,6 +899,7 @@ NetHandler::startCop(NetEvent *ne)
   ink_assert(!open_list.in(ne));
 
   open_list.enqueue(ne);
+  _schedule_timeout(ne, Thread::get_hrtime());
 }
 
 TS_INLINE void
@@ -891,7 +908,27 @@ NetHandler::stopCop(NetEvent *ne)
   ink_release_assert(ne->nh == this);
 
   open_list.remove(ne);
-  cop_list.remove(ne);
+  timeout_wheel.cancel(ne);
+  if (ne->timeout_in_enabled_list) {
+    timeout_enable_list.remove(ne);
+    ne->timeout_in_enabled_list = 0;
+  }
   remove_from_keep_alive_queue(ne);
   remove_from_active_queue(ne);
 }
+
+TS_INLINE void
+NetHandler::update_timeout(NetEvent *ne)
+{
+  MUTEX_TRY_LOCK(lock, mutex, this_ethread());
+  if (!lock.is_locked()) {
+    // picked up by process_enabled_list
+    if (!ink_atomic_swap(&ne->timeout_in_enabled_list, 1)) {
+      timeout_enable_list.push(ne);
+    }
+    return;
+  }
+  if (open_list.in(ne)) {
+    _schedule_timeout(ne, Thread::get_hrtime());
+  }
+}
@@ -0,0 +1,160 @@
+/** @file
+
+  io_uring network I/O for UnixNetVConnection.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_config.h"
+
+#if TS_USE_LINUX_IO_URING
+
+#include <liburing.h>
+
+#include "I_IOBuffer.h"
+#include "I_Net.h"
+
+class NetHandler;
+class UnixNetVConnection;
+struct NetAccept;
+struct NetUringState;
+
+/** An operation in the ring, the user data of its submission queue entries.
+ */
+struct NetUringOp {
+  enum Type { RECV, SEND, ACCEPT };
+
+  Type type;
+  bool in_flight       = false;
+  NetUringState *state = nullptr; ///< RECV and SEND
+  NetAccept *na        = nullptr; ///< ACCEPT
+
+  explicit NetUringOp(Type t) : type(t) {}
+};
+
+/** The io_uring state of a UnixNetVConnection.
+
+    The socket has a multishot receive in the ring, which fills buffers of the ring's buffer
+    group. Received buffers are queued here as IOBufferBlocks until read_from_net() hands them
+    to the read VIO without copying. At most one send is in the ring at a time, its data is held
+    in @a send_blocks until it completes.
+
+    This outlives the VC when operations are still in the ring as it is closed.
+ */
+struct NetUringState {
+  UnixNetVConnection *vc = nullptr; ///< nullptr once the VC is freed.
+
+  NetUringOp recv{NetUringOp::RECV};
+  bool recv_cancelled = false;   ///< A cancel of @a recv is in the ring.
+  Ptr<IOBufferBlock> pending;    ///< Received and not yet read.
+  IOBufferBlock *pending_tail = nullptr;
+  int64_t pending_bytes       = 0;
+  int recv_end                = 1; ///< 1 while open, 0 at the end of the stream, -errno on error.
+
+  NetUringOp send{NetUringOp::SEND};
+  Ptr<IOBufferBlock> send_blocks;
+  IOBufferReader *send_reader = nullptr; ///< The reader of the data of the send.
+  struct msghdr send_msg;
+  IOVec send_iov[NET_MAX_IOV];
+  bool send_done      = false; ///< @a send_result is not yet reported.
+  int64_t send_result = 0;
+
+  NetUringState()
+  {
+    recv.state = this;
+    send.state = this;
+  }
+
+  bool
+  busy() const
+  {
+    return recv.in_flight || send.in_flight;
+  }
+};
+
+/** Per NetHandler io_uring.
+
+    Submissions are queued while the NetHandler runs and go out in one io_uring_submit() before
+    it polls. Completions are signalled on the thread's event fd, which is polled with the sockets,
+    and are reaped after polling: receives and sends mark the VC triggered and put it on the ready
+    lists so the usual read_from_net() / write_to_net() paths run, accepts are handed to the
+    NetAccept.
+ */
+class NetUring
+{
+public:
+  explicit NetUring(NetHandler *nh);
+  ~NetUring();
+
+  /// Whether the ring and its buffer group were set up.
+  bool
+  ok() const
+  {
+    return _ok;
+  }
+
+  /// Move the reads and writes of @a vc to the ring. @a vc must be connected and in the epoll set of this thread.
+  bool attach(UnixNetVConnection *vc);
+  /// Let go of @a vc, which is being freed.
+  void detach(UnixNetVConnection *vc);
+
+  /// Give up to @a n received bytes of @a s to @a buf, return the number of bytes given.
+  int64_t read(NetUringState *s, MIOBuffer *buf, int64_t n);
+  /// Receive again if the multishot receive of @a s ended.
+  void rearm(NetUringState *s);
+  /// Send @a towrite bytes from @a reader, return -EAGAIN if the send was queued or the result of the last send.
+  int64_t send(NetUringState *s, IOBufferReader *reader, int64_t towrite);
+
+  /// Accept connections on the listen socket of @a na on this thread.
+  bool accept(NetAccept *na);
+
+  /// Submit what was queued since the last call.
+  void submit();
+  /// Handle the completions.
+  void reap();
+
+private:
+  io_uring_sqe *_get_sqe();
+  bool _arm_recv(NetUringState *s);
+  bool _arm_accept(NetUringOp *op);
+  void _cancel(NetUringOp *op);
+  void _recv_done(NetUringState *s, io_uring_cqe *cqe);
+  void _send_done(NetUringState *s, io_uring_cqe *cqe);
+  void _accept_done(NetUringOp *op, io_uring_cqe *cqe);
+  void _release(NetUringState *s);
+
+  NetHandler *_nh;
+  io_uring _ring;
+  bool _ok = false;
+
+  io_uring_buf_ring *_buf_ring = nullptr;
+  Ptr<IOBufferData> *_bufs     = nullptr; ///< The buffers given to @a _buf_ring, by buffer id.
+  int _nbufs                   = 0;
+  int64_t _buf_size_index      = 0;
+  int64_t _buf_size            = 0;
+};
+
+extern int net_config_io_uring;
+extern int net_config_io_uring_entries;
+extern int net_config_io_uring_buffers;
+extern int net_config_io_uring_buffer_size;
+
+#endif
@@ -41,6 +41,7 @@
 class UnixNetVConnection;
 class NetHandler;
 struct PollDescriptor;
+struct NetUringState;
 
 inline void
 NetVCOptions::reset()
@@ -105,6 +106,44 @@ struct OOB_callback : public Continuation {
 
 enum tcp_congestion_control_t { CLIENT_SIDE, SERVER_SIDE };
 
+/** Data sent with @c MSG_ZEROCOPY.
+
+    The kernel references the pages of a zero copy send until the data has been acknowledged and
+    reports that on the socket error queue. Until then the blocks are held here so that the
+    underlying @c IOBufferData is neither freed nor reused. TCP reports completions in send order.
+
+    This is embedded in @c UnixNetVConnection which is initialized from a prototype, so it must
+    be valid when zero filled.
+ */
+struct NetZeroCopy {
+  static constexpr int MAX_PENDING = 16;
+
+  int state         = 0; ///< 0 not yet enabled, 1 enabled on the socket, -1 unavailable.
+  uint32_t next_seq = 0; ///< Kernel sequence number of the next zero copy send.
+  int head          = 0;
+  int count         = 0;
+  struct {
+    Ptr<IOBufferBlock> blocks;
+    uint32_t seq;
+  } pending[MAX_PENDING];
+
+  /// Enable zero copy sends on @a fd, return @c true if they can be used.
+  bool enable(int fd);
+  /// Hold @a blocks until the kernel has finished with the send just made.
+  void track(IOBufferBlock *blocks);
+  /// Release the sends completed on @a fd, return the number still pending.
+  int reap(int fd);
+  /// Take over the pending sends of @a that.
+  void move(NetZeroCopy &that);
+  void clear();
+
+  bool
+  full() const
+  {
+    return count == MAX_PENDING;
+  }
+};
+
 class UnixNetVConnection : public NetVConnection, public NetEvent
 {
 public:
@@ -284,6 +323,10 @@ public:
   unsigned int id = 0;
 
   Connection con;
+  NetZeroCopy zero_copy;
+#if TS_USE_LINUX_IO_URING
+  NetUringState *uring = nullptr; ///< Set when the reads and writes go through the io_uring of the NetHandler.
+#endif
   int recursion            = 0;
   OOB_callback *oob_ptr    = nullptr;
   bool from_accept_thread  = false;
@@ -392,14 +435,6 @@ UnixNetVConnection::get_inactivity_timeout()
   return inactivity_timeout_in;
 }
 
-inline void
-UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
-{
-  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
-  active_timeout_in        = timeout_in;
-  next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
-}
-
 inline void
 UnixNetVConnection::cancel_inactivity_timeout()
 {
@@ -1500,6 +1500,21 @@ QUICNetVConnection::_state_common_send_packet()
 {
   uint32_t packet_count = 0;
   uint32_t error        = 0;
+  // Full sized datagrams go out together as one train, sent with UDP GSO where the kernel supports it.
+  Ptr<IOBufferBlock> train;
+  IOBufferBlock *train_tail = nullptr;
+  uint32_t train_segment    = 0;
+  int train_count           = 0;
+
+  auto send_train = [&]() {
+    if (train) {
+      this->_packet_handler->send_packet(this, train, train_count > 1 ? train_segment : 0);
+      train       = nullptr;
+      train_tail  = nullptr;
+      train_count = 0;
+    }
+  };
+
   while (error == 0 && packet_count < PACKET_PER_EVENT) {
     uint32_t window = this->_congestion_controller->credit();
 
@@ -1577,12 +1592,28 @@ QUICNetVConnection::_state_common_send_packet()
     }
 
     if (written) {
-      this->_packet_handler->send_packet(this, udp_payload);
+      // A datagram joins the train if it is not longer than the ones on it, a shorter one has to be the last.
+      if (train && (written > train_segment || train_count == UDP_GSO_MAX_SEGMENTS ||
+                    (train_count + 1) * train_segment > UDP_GSO_MAX_BYTES)) {
+        send_train();
+      }
+      if (train) {
+        train_tail->next = udp_payload;
+      } else {
+        train         = udp_payload;
+        train_segment = written;
+      }
+      train_tail = udp_payload.get();
+      ++train_count;
+      if (written < train_segment) {
+        send_train();
+      }
     } else {
       udp_payload->dealloc();
       break;
     }
   }
+  send_train();
 
   if (packet_count) {
     this->_context->trigger(QUICContext::CallbackEvent::METRICS_UPDATE, this->_congestion_controller->congestion_window(),
@@ -98,9 +98,9 @@ QUICPacketHandler::_send_packet(const QUICPacket &packet, UDPConnection *udp_con
 }
 
 void
-QUICPacketHandler::_send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload)
+QUICPacketHandler::_send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IOBufferBlock> udp_payload, uint16_t segment_size)
 {
-  UDPPacket *udp_packet = new_UDPPacket(addr, 0, udp_payload);
+  UDPPacket *udp_packet = new_UDPPacket(addr, 0, udp_payload, segment_size);
 
   if (is_debug_tag_set(v_debug_tag)) {
     ip_port_text_buffer ipb;
@@ -120,8 +120,9 @@ QUICPacketHandler::_send_packet(UDPConnection *udp_con, IpEndpoint &addr, Ptr<IO
       }
     }
 
-    QUICVPHDebug(dcid, scid, "send %s packet to %s from port %u size=%" PRId64, (QUICInvariants::is_long_header(buf) ? "LH" : "SH"),
-                 ats_ip_nptop(&addr, ipb, sizeof(ipb)), udp_con->getPortNum(), buf_len);
+    QUICVPHDebug(dcid, scid, "send %s packet to %s from port %u size=%" PRId64 " segment_size=%u",
+                 (QUICInvariants::is_long_header(buf) ? "LH" : "SH"), ats_ip_nptop(&addr, ipb, sizeof(ipb)), udp_con->getPortNum(),
+                 buf_len, segment_size);
   }
 
   udp_con->send(this->_get_continuation(), udp_packet);
@@ -392,9 +393,9 @@ QUICPacketHandler::send_packet(const QUICPacket &packet, QUICNetVConnection *vc,
 }
 
 void
-QUICPacketHandler::send_packet(QUICNetVConnection *vc, const Ptr<IOBufferBlock> &udp_payload)
+QUICPacketHandler::send_packet(QUICNetVConnection *vc, const Ptr<IOBufferBlock> &udp_payload, uint16_t segment_size)
 {
-  this->_send_packet(vc->get_udp_con(), vc->con.addr, udp_payload);
+  this->_send_packet(vc->get_udp_con(), vc->con.addr, udp_payload, segment_size);
 }
 
 int
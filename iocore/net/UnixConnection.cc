@@ -413,6 +413,16 @@ Connection::apply_options(NetVCOptions const &opt)
     }
   }
 
+#ifdef SO_BUSY_POLL
+  if (net_config_sock_busy_poll_usec > 0) {
+    // Raising this above the net.core.busy_read sysctl needs CAP_NET_ADMIN, without it the socket just does not busy poll.
+    int usec = net_config_sock_busy_poll_usec;
+    if (safe_setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, reinterpret_cast<char *>(&usec), sizeof(usec)) < 0) {
+      Debug("socket", "::open: setsockopt() SO_BUSY_POLL failed: %s", strerror(errno));
+    }
+  }
+#endif
+
 #if TS_HAS_SO_MARK
   uint32_t mark = opt.packet_mark;
   safe_setsockopt(fd, SOL_SOCKET, SO_MARK, reinterpret_cast<char *>(&mark), sizeof(uint32_t));
@@ -39,9 +39,9 @@ const std::bitset<NetHandler::CONFIG_ITEM_COUNT> NetHandler::config_value_affect
 
 extern "C" void fd_reify(struct ev_loop *);
 
-// INKqa10496
 // One Inactivity cop runs on each thread once every second and
-// loops through the list of NetEvents and calls the timeouts
+// trims the active and keep-alive queues. The timeouts of the
+// NetEvents are handled by the timeout wheel of the NetHandler.
 class InactivityCop : public Continuation
 {
 public:
@@ -50,65 +50,9 @@ public:
   check_inactivity(int event, Event *e)
   {
     (void)event;
-    ink_hrtime now = Thread::get_hrtime();
     NetHandler &nh = *get_NetHandler(this_ethread());
 
     Debug("inactivity_cop_check", "Checking inactivity on Thread-ID #%d", this_ethread()->id);
-    // The rest NetEvents in cop_list which are not triggered between InactivityCop runs.
-    // Use pop() to catch any closes caused by callbacks.
-    while (NetEvent *ne = nh.cop_list.pop()) {
-      // If we cannot get the lock don't stop just keep cleaning
-      MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
-      if (!lock.is_locked()) {
-        NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
-        continue;
-      }
-
-      if (ne->closed) {
-        nh.free_netevent(ne);
-        continue;
-      }
-
-      // set a default inactivity timeout if one is not set
-      if (ne->next_inactivity_timeout_at == 0 && nh.config.default_inactivity_timeout > 0) {
-        Debug("inactivity_cop", "vc: %p inactivity timeout not set, setting a default of %d", ne,
-              nh.config.default_inactivity_timeout);
-        ne->set_default_inactivity_timeout(HRTIME_SECONDS(nh.config.default_inactivity_timeout));
-        NET_INCREMENT_DYN_STAT(default_inactivity_timeout_applied_stat);
-      }
-
-      if (ne->next_inactivity_timeout_at && ne->next_inactivity_timeout_at < now) {
-        if (ne->is_default_inactivity_timeout()) {
-          // track the connections that timed out due to default inactivity
-          NET_INCREMENT_DYN_STAT(default_inactivity_timeout_count_stat);
-        }
-        if (nh.keep_alive_queue.in(ne)) {
-          // only stat if the connection is in keep-alive, there can be other inactivity timeouts
-          ink_hrtime diff = (now - (ne->next_inactivity_timeout_at - ne->inactivity_timeout_in)) / HRTIME_SECOND;
-          NET_SUM_DYN_STAT(keep_alive_queue_timeout_total_stat, diff);
-          NET_INCREMENT_DYN_STAT(keep_alive_queue_timeout_count_stat);
-        }
-        Debug("inactivity_cop_verbose", "ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
-              ink_hrtime_to_sec(now), ne->next_inactivity_timeout_at, ne->inactivity_timeout_in);
-        ne->callback(VC_EVENT_INACTIVITY_TIMEOUT, e);
-      } else if (ne->next_activity_timeout_at && ne->next_activity_timeout_at < now) {
-        Debug("inactivity_cop_verbose", "active ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
-              ink_hrtime_to_sec(now), ne->next_activity_timeout_at, ne->active_timeout_in);
-        ne->callback(VC_EVENT_ACTIVE_TIMEOUT, e);
-      }
-    }
-    // The cop_list is empty now.
-    // Let's reload the cop_list from open_list again.
-    forl_LL(NetEvent, ne, nh.open_list)
-    {
-      if (ne->get_thread() == this_ethread()) {
-        nh.cop_list.push(ne);
-      }
-    }
-    // NetHandler will remove NetEvent from cop_list if it is triggered.
-    // As the NetHandler runs, the number of NetEvents in the cop_list is decreasing.
-    // NetHandler runs 100 times maximum between InactivityCop runs.
-    // Therefore we don't have to check all the NetEvents as much as open_list.
 
     // Cleanup the active and keep-alive queues periodically
     nh.manage_active_queue(nullptr, true); // close any connections over the active timeout
@@ -243,14 +187,18 @@ initialize_thread_for_net(EThread *thread)
 
   InactivityCop *inactivityCop = new InactivityCop(get_NetHandler(thread)->mutex);
   int cop_freq                 = 1;
+  int timeout_granularity      = 10;
 
   REC_ReadConfigInteger(cop_freq, "proxy.config.net.inactivity_check_frequency");
+  REC_ReadConfigInteger(timeout_granularity, "proxy.config.net.timeout_granularity");
   memcpy(&nh->config, &NetHandler::global_config, sizeof(NetHandler::global_config));
   nh->configure_per_thread_values();
+  nh->timeout_wheel.init(HRTIME_MSECONDS(std::max(timeout_granularity, 1)), Thread::get_hrtime_updated());
   thread->schedule_every(inactivityCop, HRTIME_SECONDS(cop_freq));
 
   thread->set_tail_handler(nh);
-  thread->ep = static_cast<EventIO *>(ats_malloc(sizeof(EventIO)));
+  thread->busy_poll_time = HRTIME_USECONDS(net_config_busy_poll_usec);
+  thread->ep             = static_cast<EventIO *>(ats_malloc(sizeof(EventIO)));
   new (thread->ep) EventIO();
   thread->ep->type = EVENTIO_ASYNC_SIGNAL;
 #if HAVE_EVENTFD
@@ -258,6 +206,16 @@ initialize_thread_for_net(EThread *thread)
 #else
   thread->ep->start(pd, thread->evpipe[0], nullptr, EVENTIO_READ);
 #endif
+
+#if TS_USE_LINUX_IO_URING
+  if (net_config_io_uring) {
+    nh->uring = new NetUring(nh);
+    if (!nh->uring->ok()) {
+      delete nh->uring;
+      nh->uring = nullptr;
+    }
+  }
+#endif
 }
 
 // NetHandler method definitions
@@ -391,6 +349,101 @@ NetHandler::process_enabled_list()
       write_ready_list.in_or_enqueue(ne);
     }
   }
+
+  SList(NetEvent, timeout_enable_link) tq(timeout_enable_list.popall());
+  while ((ne = tq.pop())) {
+    ne->timeout_in_enabled_list = 0;
+    if (open_list.in(ne)) {
+      _schedule_timeout(ne, Thread::get_hrtime());
+    }
+  }
+}
+
+//
+// Take the NetEvents whose timeouts are due out of the timeout wheel
+//
+void
+NetHandler::process_timeouts()
+{
+  ink_hrtime now = Thread::get_hrtime();
+  int expired    = timeout_wheel.advance(now, [this, now](NetEvent *ne) { _timeout_expired(ne, now); });
+  if (expired) {
+    NET_SUM_DYN_STAT(net_timeout_wheel_expired_stat, expired);
+  }
+}
+
+// Put ne in the timeout wheel at its next timeout. A timeout which is later than
+// the time ne is in the wheel at is left for then, so that activity on the
+// connection does not move it in the wheel every time.
+void
+NetHandler::_schedule_timeout(NetEvent *ne, ink_hrtime now)
+{
+  ink_hrtime at = ne->next_timeout_at();
+  if (at == 0) {
+    if (config.default_inactivity_timeout == 0) {
+      timeout_wheel.cancel(ne);
+      return;
+    }
+    // a default inactivity timeout is set on it if it has none by then
+    at = now + HRTIME_SECONDS(1);
+  } else if (at <= now) {
+    // signal an expired timeout again a second later, as long as it is not changed
+    at = now + HRTIME_SECONDS(1);
+  }
+  ink_hrtime due = timeout_wheel.due(ne);
+  if (due == 0 || at < due) {
+    timeout_wheel.schedule(ne, at);
+  }
+}
+
+void
+NetHandler::_timeout_expired(NetEvent *ne, ink_hrtime now)
+{
+  // If we cannot get the lock don't stop just try again at the next tick
+  MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
+  if (!lock.is_locked()) {
+    NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
+    timeout_wheel.schedule(ne, now);
+    return;
+  }
+
+  if (ne->closed) {
+    free_netevent(ne);
+    return;
+  }
+
+  // set a default inactivity timeout if one is not set
+  if (ne->next_inactivity_timeout_at == 0 && config.default_inactivity_timeout > 0) {
+    Debug("inactivity_cop", "vc: %p inactivity timeout not set, setting a default of %d", ne, config.default_inactivity_timeout);
+    ne->set_default_inactivity_timeout(HRTIME_SECONDS(config.default_inactivity_timeout));
+    NET_INCREMENT_DYN_STAT(default_inactivity_timeout_applied_stat);
+  }
+
+  // ne stays in the wheel until it is closed, the callback may free it
+  _schedule_timeout(ne, now);
+
+  // create a dummy event
+  Event event;
+  event.ethread = this_ethread();
+  if (ne->next_inactivity_timeout_at && ne->next_inactivity_timeout_at < now) {
+    if (ne->is_default_inactivity_timeout()) {
+      // track the connections that timed out due to default inactivity
+      NET_INCREMENT_DYN_STAT(default_inactivity_timeout_count_stat);
+    }
+    if (keep_alive_queue.in(ne)) {
+      // only stat if the connection is in keep-alive, there can be other inactivity timeouts
+      ink_hrtime diff = (now - (ne->next_inactivity_timeout_at - ne->inactivity_timeout_in)) / HRTIME_SECOND;
+      NET_SUM_DYN_STAT(keep_alive_queue_timeout_total_stat, diff);
+      NET_INCREMENT_DYN_STAT(keep_alive_queue_timeout_count_stat);
+    }
+    Debug("inactivity_cop_verbose", "ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
+          ink_hrtime_to_sec(now), ne->next_inactivity_timeout_at, ne->inactivity_timeout_in);
+    ne->callback(VC_EVENT_INACTIVITY_TIMEOUT, &event);
+  } else if (ne->next_activity_timeout_at && ne->next_activity_timeout_at < now) {
+    Debug("inactivity_cop_verbose", "active ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
+          ink_hrtime_to_sec(now), ne->next_activity_timeout_at, ne->active_timeout_in);
+    ne->callback(VC_EVENT_ACTIVE_TIMEOUT, &event);
+  }
 }
 
 //
@@ -475,7 +528,8 @@ NetHandler::mainNetEvent(int event, Event *e)
     return EVENT_CONT;
   } else {
     ink_assert(trigger_event == e && (event == EVENT_INTERVAL || event == EVENT_POLL));
-    return this->waitForActivity(-1);
+    this->waitForActivity(-1);
+    return EVENT_CONT;
   }
 }
 
@@ -489,6 +543,13 @@ NetHandler::waitForActivity(ink_hrtime timeout)
 
   process_enabled_list();
 
+#if TS_USE_LINUX_IO_URING
+  // Everything queued in the ring since the last poll goes out in a single submit.
+  if (uring) {
+    uring->submit();
+  }
+#endif
+
   // Polling event by PollCont
   PollCont *p = get_PollCont(this->thread);
   p->do_poll(timeout);
@@ -496,14 +557,11 @@ NetHandler::waitForActivity(ink_hrtime timeout)
   // Get & Process polling result
   PollDescriptor *pd = get_PollDescriptor(this->thread);
   NetEvent *ne       = nullptr;
+  int activity       = pd->result;
   for (int x = 0; x < pd->result; x++) {
     epd = static_cast<EventIO *> get_ev_data(pd, x);
     if (epd->type == EVENTIO_READWRITE_VC) {
       ne = epd->data.ne;
-      // Remove triggered NetEvent from cop_list because it won't be timeout before next InactivityCop runs.
-      if (cop_list.in(ne)) {
-        cop_list.remove(ne);
-      }
       if (get_ev_events(pd, x) & (EVENTIO_READ | EVENTIO_ERROR)) {
         ne->read.triggered = 1;
         if (!read_ready_list.in(ne)) {
@@ -544,9 +602,17 @@ NetHandler::waitForActivity(ink_hrtime timeout)
 
   pd->result = 0;
 
+#if TS_USE_LINUX_IO_URING
+  if (uring) {
+    uring->reap();
+  }
+#endif
+
   process_ready_list();
 
-  return EVENT_CONT;
+  process_timeouts();
+
+  return activity;
 }
 
 void
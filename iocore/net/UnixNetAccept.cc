@@ -21,10 +21,17 @@
   limitations under the License.
  */
 
+#include <atomic>
+
 #include <tscore/TSSystemState.h>
 
 #include "P_Net.h"
 
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+#include <sched.h>
+#include <linux/filter.h>
+#endif
+
 #ifdef ROUNDUP
 #undef ROUNDUP
 #endif
@@ -37,6 +44,100 @@ int accept_till_done   = 1;
 // in different threads at the same time
 Ptr<ProxyMutex> naVecMutex;
 std::vector<NetAccept *> naVec;
+
+/** The per thread listen sockets of a port with CPU steering.
+
+    The sockets join their SO_REUSEPORT group in the order of the threads, so the index of a
+    socket in the group is the index of its thread. When every thread has told which CPUs it is
+    bound to, a program that maps the CPU which received a connection to a socket index is
+    attached to the group, so connections are accepted on the thread bound to that CPU.
+ */
+struct NetAcceptSteering {
+  int fd = NO_FD; ///< A socket of the group.
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+  std::vector<cpu_set_t> cpus; ///< The CPUs each thread is bound to, empty if it may run on all of them.
+#endif
+  std::atomic<int> pending;
+
+  explicit NetAcceptSteering(int n) : pending(n)
+  {
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+    cpus.resize(n);
+    for (auto &set : cpus) {
+      CPU_ZERO(&set);
+    }
+#endif
+  }
+};
+
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+// The CPUs the calling thread is bound to, none if it may run on all of them.
+static void
+bound_cpus(cpu_set_t *set)
+{
+  if (sched_getaffinity(0, sizeof(*set), set) != 0 || CPU_COUNT(set) >= ink_number_of_processors()) {
+    CPU_ZERO(set);
+  }
+}
+
+// Attach the program steering connections by the CPU which received them to the group of @a fd.
+static int
+attach_steering(int fd, const std::vector<cpu_set_t> &cpus)
+{
+  int n = cpus.size();
+  std::vector<int> owner(CPU_SETSIZE, -1);
+  std::vector<sock_filter> code;
+
+  for (int i = 0; i < n; ++i) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpus[i]) && owner[cpu] < 0) {
+        owner[cpu] = i;
+      }
+    }
+  }
+
+  code.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+  // A CPU a thread is bound to goes to that thread, the others by their number modulo the threads.
+  for (int cpu = 0; cpu < CPU_SETSIZE && code.size() < BPF_MAXINSNS - 4; ++cpu) {
+    if (owner[cpu] >= 0 && cpu % n != owner[cpu]) {
+      code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cpu), 0, 1));
+      code.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(owner[cpu])));
+    }
+  }
+  code.push_back(BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(n)));
+  code.push_back(BPF_STMT(BPF_RET | BPF_A, 0));
+
+  sock_fprog prog;
+  prog.len    = code.size();
+  prog.filter = code.data();
+  return safe_setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, reinterpret_cast<char *>(&prog), sizeof(prog));
+}
+#endif
+
+// Tell the steering of @a na which CPUs the calling thread is bound to, set it up when all the threads have.
+static void
+join_steering(NetAccept *na)
+{
+  NetAcceptSteering *steering = na->steering;
+
+  na->steering = nullptr;
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+  bound_cpus(&steering->cpus[na->steering_index]);
+#endif
+  if (steering->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+  int port = ats_ip_port_host_order(&na->server.accept_addr);
+  if (attach_steering(steering->fd, steering->cpus) < 0) {
+    Warning("unable to steer connections on port %d by CPU: %d, %s", port, errno, strerror(errno));
+  } else {
+    Debug("iocore_net_accept", "steering connections on port %d by CPU to %zu threads", port, steering->cpus.size());
+  }
+#endif
+  delete steering;
+}
+
 static void
 safe_delay(int msec)
 {
@@ -207,7 +308,9 @@ NetAccept::accept_per_thread(int event, void *ep)
   int listen_per_thread = 0;
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
 
-  if (listen_per_thread == 1) {
+  if (steering) {
+    join_steering(this);
+  } else if (listen_per_thread == 1) {
     if (do_listen(NON_BLOCKING)) {
       Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
       return -1;
@@ -219,6 +322,13 @@ NetAccept::accept_per_thread(int event, void *ep)
   } else {
     SET_HANDLER((NetAcceptHandler)&NetAccept::acceptEvent);
   }
+#if TS_USE_LINUX_IO_URING
+  // The ring accepts the connections, no need to poll the listen socket.
+  NetUring *uring = get_NetHandler(this_ethread())->uring;
+  if (uring && accept_fn == net_accept && uring->accept(this)) {
+    return 0;
+  }
+#endif
   PollDescriptor *pd = get_PollDescriptor(this_ethread());
   if (this->ep.start(pd, this, EVENTIO_READ) < 0) {
     Fatal("[NetAccept::accept_per_thread]:error starting EventIO");
@@ -231,10 +341,13 @@ void
 NetAccept::init_accept_per_thread()
 {
   int i, n;
-  int listen_per_thread = 0;
+  int listen_per_thread           = 0;
+  int listen_steering             = 0;
+  NetAcceptSteering *steering_set = nullptr;
 
   ink_assert(opt.etype >= 0);
   REC_ReadConfigInteger(listen_per_thread, "proxy.config.exec_thread.listen");
+  REC_ReadConfigInteger(listen_steering, "proxy.config.exec_thread.listen_steering");
 
   if (listen_per_thread == 0) {
     if (do_listen(NON_BLOCKING)) {
@@ -246,10 +359,32 @@ NetAccept::init_accept_per_thread()
   SET_HANDLER((NetAcceptHandler)&NetAccept::accept_per_thread);
   n = eventProcessor.thread_group[opt.etype]._count;
 
+  if (listen_per_thread == 1 && listen_steering == 1) {
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+    if (n > 1) {
+      steering_set = new NetAcceptSteering(n);
+    }
+#else
+    Warning("proxy.config.exec_thread.listen_steering is not supported on this platform");
+#endif
+  }
+
   for (i = 0; i < n; i++) {
     NetAccept *a = (i < n - 1) ? clone() : this;
     EThread *t   = eventProcessor.thread_group[opt.etype]._thread[i];
     a->mutex     = get_NetHandler(t)->mutex;
+    if (steering_set) {
+      // Listen here rather than on the threads so the sockets join their group in the order of the threads.
+      if (a->do_listen(NON_BLOCKING)) {
+        Fatal("[NetAccept::accept_per_thread]:error listenting on ports");
+        return;
+      }
+      if (i == 0) {
+        steering_set->fd = a->server.fd;
+      }
+      a->steering       = steering_set;
+      a->steering_index = i;
+    }
     t->schedule_imm(a);
   }
 }
@@ -412,12 +547,11 @@ NetAccept::acceptFastEvent(int event, void *ep)
   Event *e = static_cast<Event *>(ep);
   (void)event;
   (void)e;
-  int bufsz, res = 0;
+  int res = 0;
   Connection con;
   con.sock_type = SOCK_STREAM;
 
-  UnixNetVConnection *vc = nullptr;
-  int loop               = accept_till_done;
+  int loop = accept_till_done;
 
   do {
     socklen_t sz = sizeof(con.addr);
@@ -425,95 +559,26 @@ NetAccept::acceptFastEvent(int event, void *ep)
     con.fd       = fd;
 
     if (likely(fd >= 0)) {
-      // check for throttle
-      if (!opt.backdoor && check_net_throttle(ACCEPT)) {
-        // close the connection as we are in throttle state
-        con.close();
-        NET_SUM_DYN_STAT(net_connections_throttled_in_stat, 1);
-        continue;
-      }
-      Debug("iocore_net", "accepted a new socket: %d", fd);
-      NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
-      if (opt.send_bufsize > 0) {
-        if (unlikely(socketManager.set_sndbuf_size(fd, opt.send_bufsize))) {
-          bufsz = ROUNDUP(opt.send_bufsize, 1024);
-          while (bufsz > 0) {
-            if (!socketManager.set_sndbuf_size(fd, bufsz)) {
-              break;
-            }
-            bufsz -= 1024;
-          }
-        }
-      }
-      if (opt.recv_bufsize > 0) {
-        if (unlikely(socketManager.set_rcvbuf_size(fd, opt.recv_bufsize))) {
-          bufsz = ROUNDUP(opt.recv_bufsize, 1024);
-          while (bufsz > 0) {
-            if (!socketManager.set_rcvbuf_size(fd, bufsz)) {
-              break;
-            }
-            bufsz -= 1024;
-          }
-        }
-      }
-    } else {
-      res = fd;
+      accept_connection(e->ethread, con);
+      continue;
     }
     // check return value from accept()
-    if (res < 0) {
-      Debug("iocore_net", "received : %s", strerror(errno));
-      res = -errno;
-      if (res == -EAGAIN || res == -ECONNABORTED
+    Debug("iocore_net", "received : %s", strerror(errno));
+    res = -errno;
+    if (res == -EAGAIN || res == -ECONNABORTED
 #if defined(linux)
-          || res == -EPIPE
+        || res == -EPIPE
 #endif
-      ) {
-        goto Ldone;
-      } else if (accept_error_seriousness(res) >= 0) {
-        check_transient_accept_error(res);
-        goto Ldone;
-      }
-      if (!action_->cancelled) {
-        action_->continuation->handleEvent(EVENT_ERROR, (void *)static_cast<intptr_t>(res));
-      }
-      goto Lerror;
-    }
-
-    vc = (UnixNetVConnection *)this->getNetProcessor()->allocate_vc(e->ethread);
-    ink_release_assert(vc);
-
-    NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, 1);
-    vc->id = net_next_connection_number();
-    vc->con.move(con);
-    vc->submit_time = Thread::get_hrtime();
-    vc->action_     = *action_;
-    vc->set_is_transparent(opt.f_inbound_transparent);
-    vc->set_is_proxy_protocol(opt.f_proxy_protocol);
-    vc->options.packet_mark = opt.packet_mark;
-    vc->options.packet_tos  = opt.packet_tos;
-    vc->options.ip_family   = opt.ip_family;
-    vc->apply_options();
-    vc->set_context(NET_VCONNECTION_IN);
-    if (opt.f_mptcp) {
-      vc->set_mptcp_state(); // Try to get the MPTCP state, and update accordingly
+    ) {
+      goto Ldone;
+    } else if (accept_error_seriousness(res) >= 0) {
+      check_transient_accept_error(res);
+      goto Ldone;
     }
-
-#ifdef USE_EDGE_TRIGGER
-    // Set the vc as triggered and place it in the read ready queue later in case there is already data on the socket.
-    if (server.http_accept_filter) {
-      vc->read.triggered = 1;
+    if (!action_->cancelled) {
+      action_->continuation->handleEvent(EVENT_ERROR, (void *)static_cast<intptr_t>(res));
     }
-#endif
-    SET_CONTINUATION_HANDLER(vc, (NetVConnHandler)&UnixNetVConnection::acceptEvent);
-
-    EThread *t    = e->ethread;
-    NetHandler *h = get_NetHandler(t);
-    // Assign NetHandler->mutex to NetVC
-    vc->mutex = h->mutex;
-    // We must be holding the lock already to do later do_io_read's
-    SCOPED_MUTEX_LOCK(lock, vc->mutex, e->ethread);
-    vc->handleEvent(EVENT_NONE, nullptr);
-    vc = nullptr;
+    goto Lerror;
   } while (loop);
 
 Ldone:
@@ -527,6 +592,79 @@ Lerror:
   return EVENT_DONE;
 }
 
+void
+NetAccept::accept_connection(EThread *t, Connection &con)
+{
+  int bufsz;
+  int fd = con.fd;
+
+  // check for throttle
+  if (!opt.backdoor && check_net_throttle(ACCEPT)) {
+    // close the connection as we are in throttle state
+    con.close();
+    NET_SUM_DYN_STAT(net_connections_throttled_in_stat, 1);
+    return;
+  }
+  Debug("iocore_net", "accepted a new socket: %d", fd);
+  NET_SUM_GLOBAL_DYN_STAT(net_tcp_accept_stat, 1);
+  if (opt.send_bufsize > 0) {
+    if (unlikely(socketManager.set_sndbuf_size(fd, opt.send_bufsize))) {
+      bufsz = ROUNDUP(opt.send_bufsize, 1024);
+      while (bufsz > 0) {
+        if (!socketManager.set_sndbuf_size(fd, bufsz)) {
+          break;
+        }
+        bufsz -= 1024;
+      }
+    }
+  }
+  if (opt.recv_bufsize > 0) {
+    if (unlikely(socketManager.set_rcvbuf_size(fd, opt.recv_bufsize))) {
+      bufsz = ROUNDUP(opt.recv_bufsize, 1024);
+      while (bufsz > 0) {
+        if (!socketManager.set_rcvbuf_size(fd, bufsz)) {
+          break;
+        }
+        bufsz -= 1024;
+      }
+    }
+  }
+
+  UnixNetVConnection *vc = (UnixNetVConnection *)this->getNetProcessor()->allocate_vc(t);
+  ink_release_assert(vc);
+
+  NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, 1);
+  vc->id = net_next_connection_number();
+  vc->con.move(con);
+  vc->submit_time = Thread::get_hrtime();
+  vc->action_     = *action_;
+  vc->set_is_transparent(opt.f_inbound_transparent);
+  vc->set_is_proxy_protocol(opt.f_proxy_protocol);
+  vc->options.packet_mark = opt.packet_mark;
+  vc->options.packet_tos  = opt.packet_tos;
+  vc->options.ip_family   = opt.ip_family;
+  vc->apply_options();
+  vc->set_context(NET_VCONNECTION_IN);
+  if (opt.f_mptcp) {
+    vc->set_mptcp_state(); // Try to get the MPTCP state, and update accordingly
+  }
+
+#ifdef USE_EDGE_TRIGGER
+  // Set the vc as triggered and place it in the read ready queue later in case there is already data on the socket.
+  if (server.http_accept_filter) {
+    vc->read.triggered = 1;
+  }
+#endif
+  SET_CONTINUATION_HANDLER(vc, (NetVConnHandler)&UnixNetVConnection::acceptEvent);
+
+  NetHandler *h = get_NetHandler(t);
+  // Assign NetHandler->mutex to NetVC
+  vc->mutex = h->mutex;
+  // We must be holding the lock already to do later do_io_read's
+  SCOPED_MUTEX_LOCK(lock, vc->mutex, t);
+  vc->handleEvent(EVENT_NONE, nullptr);
+}
+
 int
 NetAccept::acceptLoopEvent(int event, Event *e)
 {
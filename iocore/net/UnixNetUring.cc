@@ -0,0 +1,464 @@
+/** @file
+
+  io_uring network I/O for UnixNetVConnection.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+
+#if TS_USE_LINUX_IO_URING
+
+// The buffer group of the provided buffers, there is one per ring.
+#define NET_URING_BGID 0
+// A receive is stopped when this many buffers of a connection are not read yet.
+#define NET_URING_MAX_PENDING_BUFFERS 16
+
+int net_config_io_uring             = 0;
+int net_config_io_uring_entries     = 1024;
+int net_config_io_uring_buffers     = 1024;
+int net_config_io_uring_buffer_size = 4096;
+
+NetUring::NetUring(NetHandler *nh) : _nh(nh)
+{
+  int ret = io_uring_queue_init(net_config_io_uring_entries, &_ring, 0);
+  if (ret < 0) {
+    Warning("io_uring_queue_init(%d) failed: %s (%d), using epoll for network I/O", net_config_io_uring_entries, strerror(-ret),
+            -ret);
+    return;
+  }
+
+  // The kernel wants a power of 2 number of buffers.
+  _nbufs = 1;
+  while (_nbufs < net_config_io_uring_buffers && _nbufs < 32768) {
+    _nbufs <<= 1;
+  }
+  _buf_size_index = iobuffer_size_to_index(net_config_io_uring_buffer_size, MAX_BUFFER_SIZE_INDEX);
+  _buf_size       = index_to_buffer_size(_buf_size_index);
+
+  _buf_ring = io_uring_setup_buf_ring(&_ring, _nbufs, NET_URING_BGID, 0, &ret);
+  if (_buf_ring == nullptr) {
+    Warning("io_uring_setup_buf_ring(%d) failed: %s (%d), using epoll for network I/O", _nbufs, strerror(-ret), -ret);
+    io_uring_queue_exit(&_ring);
+    return;
+  }
+  _bufs    = new Ptr<IOBufferData>[_nbufs];
+  int mask = io_uring_buf_ring_mask(_nbufs);
+  for (int i = 0; i < _nbufs; ++i) {
+    _bufs[i] = new_IOBufferData(_buf_size_index, MEMALIGNED);
+    io_uring_buf_ring_add(_buf_ring, _bufs[i]->data(), _buf_size, i, mask, i);
+  }
+  io_uring_buf_ring_advance(_buf_ring, _nbufs);
+
+#if HAVE_EVENTFD
+  ret = io_uring_register_eventfd(&_ring, nh->thread->evfd);
+  if (ret < 0) {
+    Debug("iocore_net", "io_uring_register_eventfd failed: %s (%d)", strerror(-ret), -ret);
+  }
+#endif
+  _ok = true;
+}
+
+NetUring::~NetUring()
+{
+  if (_ok) {
+    io_uring_free_buf_ring(&_ring, _buf_ring, _nbufs, NET_URING_BGID);
+    io_uring_queue_exit(&_ring);
+    delete[] _bufs;
+  }
+}
+
+io_uring_sqe *
+NetUring::_get_sqe()
+{
+  io_uring_sqe *sqe = io_uring_get_sqe(&_ring);
+  if (sqe == nullptr) {
+    // The submission queue is full, make room.
+    submit();
+    sqe = io_uring_get_sqe(&_ring);
+  }
+  return sqe;
+}
+
+bool
+NetUring::_arm_recv(NetUringState *s)
+{
+  io_uring_sqe *sqe = _get_sqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  io_uring_prep_recv_multishot(sqe, s->vc->con.fd, nullptr, 0, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = NET_URING_BGID;
+  io_uring_sqe_set_data(sqe, &s->recv);
+  s->recv.in_flight = true;
+  return true;
+}
+
+bool
+NetUring::_arm_accept(NetUringOp *op)
+{
+  io_uring_sqe *sqe = _get_sqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  io_uring_prep_multishot_accept(sqe, op->na->server.fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  io_uring_sqe_set_data(sqe, op);
+  op->in_flight = true;
+  return true;
+}
+
+void
+NetUring::_cancel(NetUringOp *op)
+{
+  io_uring_sqe *sqe = _get_sqe();
+  if (sqe != nullptr) {
+    io_uring_prep_cancel(sqe, op, 0);
+    io_uring_sqe_set_data(sqe, nullptr);
+  }
+}
+
+bool
+NetUring::attach(UnixNetVConnection *vc)
+{
+  NetUringState *s = new NetUringState;
+  s->vc            = vc;
+  if (!_arm_recv(s)) {
+    delete s;
+    return false;
+  }
+  vc->uring = s;
+
+  // The ring reports what epoll did for this socket. The EventIO is kept, its stop() finds nothing to remove.
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  epoll_ctl(vc->ep.event_loop->epoll_fd, EPOLL_CTL_DEL, vc->ep.fd, &ev);
+
+  // Sends do not wait for the socket to be writable.
+  vc->write.triggered = 1;
+  if (vc->write.enabled) {
+    _nh->write_ready_list.in_or_enqueue(vc);
+  }
+  Debug("iocore_net", "io_uring attached to vc %p fd %d", vc, vc->con.fd);
+  return true;
+}
+
+void
+NetUring::detach(UnixNetVConnection *vc)
+{
+  NetUringState *s = vc->uring;
+  vc->uring        = nullptr;
+  s->vc            = nullptr;
+  s->pending       = nullptr;
+  s->pending_tail  = nullptr;
+  s->pending_bytes = 0;
+  if (s->recv.in_flight && !s->recv_cancelled) {
+    _cancel(&s->recv);
+    s->recv_cancelled = true;
+  }
+  // A send in the ring is left to complete, @a send_blocks holds its data until then.
+  if (!s->busy()) {
+    _release(s);
+  }
+}
+
+void
+NetUring::_release(NetUringState *s)
+{
+  delete s;
+}
+
+int64_t
+NetUring::read(NetUringState *s, MIOBuffer *buf, int64_t n)
+{
+  int64_t done = 0;
+  while (done < n && s->pending) {
+    IOBufferBlock *b = s->pending.get();
+    int64_t avail    = b->read_avail();
+    if (avail <= n - done) {
+      Ptr<IOBufferBlock> next = b->next;
+      b->next                 = nullptr;
+      buf->append_block(b);
+      s->pending = next;
+      done += avail;
+    } else {
+      IOBufferBlock *c = b->clone();
+      c->_end          = c->_start + (n - done);
+      c->_buf_end      = c->_end;
+      buf->append_block(c);
+      b->consume(n - done);
+      done = n;
+    }
+  }
+  if (!s->pending) {
+    s->pending_tail = nullptr;
+  }
+  s->pending_bytes -= done;
+  rearm(s);
+
+  if (done > 0) {
+    return done;
+  }
+  return s->recv_end <= 0 ? s->recv_end : -EAGAIN;
+}
+
+void
+NetUring::rearm(NetUringState *s)
+{
+  if (!s->recv.in_flight && s->recv_end > 0 && s->pending_bytes < NET_URING_MAX_PENDING_BUFFERS * _buf_size) {
+    _arm_recv(s);
+  }
+}
+
+int64_t
+NetUring::send(NetUringState *s, IOBufferReader *reader, int64_t towrite)
+{
+  if (s->send_done) {
+    s->send_done = false;
+    // A result for another VIO is of no use to this one.
+    if (s->send_result != 0 && s->send_reader == reader) {
+      return s->send_result;
+    }
+  }
+  if (s->send.in_flight) {
+    return -EAGAIN;
+  }
+
+  IOBufferReader *tmp_reader = reader->clone();
+  int64_t try_to_write       = 0;
+  unsigned niov              = 0;
+  while (niov < NET_MAX_IOV && try_to_write < towrite) {
+    int64_t len = tmp_reader->block_read_avail();
+    if (len <= 0) {
+      break;
+    }
+    if (len > towrite - try_to_write) {
+      len = towrite - try_to_write;
+    }
+    s->send_iov[niov].iov_base = tmp_reader->start();
+    s->send_iov[niov].iov_len  = len;
+    niov++;
+    try_to_write += len;
+    tmp_reader->consume(len);
+  }
+  tmp_reader->dealloc();
+  ink_assert(niov > 0);
+
+  io_uring_sqe *sqe = _get_sqe();
+  if (sqe == nullptr) {
+    // No room in the ring, write it the usual way.
+    return socketManager.writev(s->vc->con.fd, s->send_iov, niov);
+  }
+
+  // The data stays in the reader until the send completes, but the buffer may be freed before that.
+  s->send_blocks = iobufferblock_clone(reader->block.get(), reader->start_offset, try_to_write);
+  s->send_reader = reader;
+  ink_zero(s->send_msg);
+  s->send_msg.msg_iov    = s->send_iov;
+  s->send_msg.msg_iovlen = niov;
+  io_uring_prep_sendmsg(sqe, s->vc->con.fd, &s->send_msg, MSG_NOSIGNAL);
+  io_uring_sqe_set_data(sqe, &s->send);
+  s->send.in_flight = true;
+  return -EAGAIN;
+}
+
+bool
+NetUring::accept(NetAccept *na)
+{
+  NetUringOp *op = new NetUringOp(NetUringOp::ACCEPT);
+  op->na         = na;
+  if (!_arm_accept(op)) {
+    delete op;
+    return false;
+  }
+  Debug("iocore_net", "io_uring accepting on fd %d", na->server.fd);
+  return true;
+}
+
+void
+NetUring::submit()
+{
+  if (io_uring_sq_ready(&_ring) == 0) {
+    return;
+  }
+  ProxyMutex *mutex = _nh->mutex.get();
+  int ret;
+  do {
+    ret = io_uring_submit(&_ring);
+  } while (ret == -EINTR);
+  if (ret < 0) {
+    // What the kernel did not take stays in the submission queue for the next pass.
+    Debug("iocore_net", "io_uring_submit failed: %s (%d)", strerror(-ret), -ret);
+  } else {
+    NET_INCREMENT_DYN_STAT(net_io_uring_submits_stat);
+  }
+}
+
+void
+NetUring::reap()
+{
+  ProxyMutex *mutex = _nh->mutex.get();
+  io_uring_cqe *cqe;
+  unsigned head;
+  unsigned n = 0;
+
+  io_uring_for_each_cqe(&_ring, head, cqe)
+  {
+    ++n;
+    NetUringOp *op = static_cast<NetUringOp *>(io_uring_cqe_get_data(cqe));
+    if (op == nullptr) {
+      continue; // a cancel
+    }
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+      op->in_flight = false;
+    }
+    switch (op->type) {
+    case NetUringOp::RECV:
+      _recv_done(op->state, cqe);
+      break;
+    case NetUringOp::SEND:
+      _send_done(op->state, cqe);
+      break;
+    case NetUringOp::ACCEPT:
+      _accept_done(op, cqe);
+      break;
+    }
+  }
+  if (n) {
+    io_uring_cq_advance(&_ring, n);
+    NET_SUM_DYN_STAT(net_io_uring_completions_stat, n);
+  }
+}
+
+void
+NetUring::_recv_done(NetUringState *s, io_uring_cqe *cqe)
+{
+  int res = cqe->res;
+
+  if (cqe->flags & IORING_CQE_F_BUFFER) {
+    int bid                = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    Ptr<IOBufferData> data = _bufs[bid];
+
+    // Hand the buffer over and give the ring a new one in its place.
+    _bufs[bid] = new_IOBufferData(_buf_size_index, MEMALIGNED);
+    io_uring_buf_ring_add(_buf_ring, _bufs[bid]->data(), _buf_size, bid, io_uring_buf_ring_mask(_nbufs), 0);
+    io_uring_buf_ring_advance(_buf_ring, 1);
+
+    if (res > 0 && s->vc) {
+      IOBufferBlock *b = new_IOBufferBlock();
+      b->set(data.get(), res, 0);
+      if (s->pending_tail) {
+        s->pending_tail->next = b;
+      } else {
+        s->pending = b;
+      }
+      s->pending_tail = b;
+      s->pending_bytes += res;
+    }
+  }
+
+  if (!s->recv.in_flight) {
+    s->recv_cancelled = false;
+  }
+  if (res == 0) {
+    s->recv_end = 0;
+  } else if (res < 0 && res != -ENOBUFS && res != -ECANCELED) {
+    s->recv_end = res;
+  }
+
+  UnixNetVConnection *vc = s->vc;
+  if (vc == nullptr) {
+    if (!s->busy()) {
+      _release(s);
+    }
+    return;
+  }
+
+  // Stop receiving while the connection is not read, read_from_net() starts it again.
+  if (s->recv.in_flight && !s->recv_cancelled && s->pending_bytes >= NET_URING_MAX_PENDING_BUFFERS * _buf_size) {
+    _cancel(&s->recv);
+    s->recv_cancelled = true;
+  }
+
+  vc->read.triggered = 1;
+  _nh->read_ready_list.in_or_enqueue(vc);
+}
+
+void
+NetUring::_send_done(NetUringState *s, io_uring_cqe *cqe)
+{
+  s->send_blocks = nullptr;
+
+  UnixNetVConnection *vc = s->vc;
+  if (vc == nullptr) {
+    if (!s->busy()) {
+      _release(s);
+    }
+    return;
+  }
+
+  s->send_result = cqe->res;
+  s->send_done   = true;
+
+  vc->write.triggered = 1;
+  _nh->write_ready_list.in_or_enqueue(vc);
+}
+
+void
+NetUring::_accept_done(NetUringOp *op, io_uring_cqe *cqe)
+{
+  NetAccept *na = op->na;
+  int fd        = cqe->res;
+
+  if (na->action_->cancelled) {
+    if (fd >= 0) {
+      socketManager.close(fd);
+    }
+    if (op->in_flight) {
+      _cancel(op);
+    } else {
+      delete op;
+    }
+    return;
+  }
+
+  if (fd >= 0) {
+    Connection con;
+    con.sock_type = SOCK_STREAM;
+    con.fd        = fd;
+    int sz        = sizeof(con.addr);
+    if (safe_getpeername(fd, &con.addr.sa, &sz) < 0) {
+      con.close();
+    } else {
+      na->accept_connection(_nh->thread, con);
+    }
+  } else if (fd != -ECANCELED && accept_error_seriousness(fd) >= 0) {
+    check_transient_accept_error(fd);
+  } else if (fd != -ECANCELED) {
+    Warning("io_uring accept on fd %d failed: %s (%d)", na->server.fd, strerror(-fd), -fd);
+  }
+
+  // A multishot accept ends on errors and when the ring runs short, start it again.
+  if (!op->in_flight && !_arm_accept(op)) {
+    Warning("Traffic Server may be unable to accept more network connections on %d", ats_ip_port_host_order(&na->server.addr));
+    delete op;
+  }
+}
+
+#endif
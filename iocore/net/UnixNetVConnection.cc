@@ -27,13 +27,146 @@
 #include "Log.h"
 
 #include <termios.h>
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#include <linux/errqueue.h>
+#define HAVE_NET_ZERO_COPY 1
+#endif
 
 #define STATE_VIO_OFFSET ((uintptr_t) & ((NetState *)0)->vio)
 #define STATE_FROM_VIO(_x) ((NetState *)(((char *)(_x)) - STATE_VIO_OFFSET))
 
+// How long a closed connection may wait for outstanding zero copy sends.
+#define ZERO_COPY_LINGER_TIMEOUT HRTIME_SECONDS(30)
+#define ZERO_COPY_LINGER_PERIOD HRTIME_MSECONDS(100)
+
 // Global
 ClassAllocator<UnixNetVConnection> netVCAllocator("netVCAllocator");
 
+bool
+NetZeroCopy::enable(int fd)
+{
+#if HAVE_NET_ZERO_COPY
+  if (state == 0) {
+    int one = 1;
+    state   = safe_setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, reinterpret_cast<char *>(&one), sizeof(one)) < 0 ? -1 : 1;
+    Debug("socket", "zero copy %s on fd %d", state > 0 ? "enabled" : "unavailable", fd);
+  }
+  return state > 0 && !full();
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+void
+NetZeroCopy::track(IOBufferBlock *blocks)
+{
+  ink_assert(!full());
+  auto &p  = pending[(head + count) % MAX_PENDING];
+  p.blocks = blocks;
+  p.seq    = next_seq++;
+  count++;
+}
+
+int
+NetZeroCopy::reap(int fd)
+{
+#if HAVE_NET_ZERO_COPY
+  while (count > 0) {
+    char control[128];
+    struct msghdr msg;
+
+    ink_zero(msg);
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    if (socketManager.recvmsg(fd, &msg, MSG_ERRQUEUE) < 0) {
+      break;
+    }
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+      if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+            (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) {
+        continue;
+      }
+      const struct sock_extended_err *serr = reinterpret_cast<const struct sock_extended_err *>(CMSG_DATA(cm));
+      if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr->ee_errno != 0) {
+        continue;
+      }
+      if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        // The kernel fell back to copying, which is more expensive than a plain write.
+        RecIncrGlobalRawStatSum(net_rsb, net_zero_copy_copied_stat, 1);
+      }
+      // [ee_info, ee_data] is the range of sequence numbers completed.
+      while (count > 0 && static_cast<int32_t>(serr->ee_data - pending[head].seq) >= 0) {
+        pending[head].blocks = nullptr;
+        head                 = (head + 1) % MAX_PENDING;
+        count--;
+      }
+    }
+  }
+#else
+  (void)fd;
+#endif
+  return count;
+}
+
+void
+NetZeroCopy::move(NetZeroCopy &that)
+{
+  clear();
+  for (; count < that.count; count++) {
+    auto &p               = that.pending[(that.head + count) % MAX_PENDING];
+    pending[count].blocks = p.blocks;
+    pending[count].seq    = p.seq;
+  }
+  state    = that.state;
+  next_seq = that.next_seq;
+  that.clear();
+}
+
+void
+NetZeroCopy::clear()
+{
+  for (; count > 0; count--) {
+    pending[head].blocks = nullptr;
+    head                 = (head + 1) % MAX_PENDING;
+  }
+  state    = 0;
+  next_seq = 0;
+  head     = 0;
+}
+
+/** Keeps the socket of a closed connection open until its zero copy sends complete.
+
+    Closing the socket does not stop the kernel from transmitting data it still references, so
+    the buffers must be held until the completions arrive, or until we give up on the peer.
+ */
+struct ZeroCopyLinger : public Continuation {
+  int fd;
+  ink_hrtime deadline;
+  NetZeroCopy zero_copy;
+
+  ZeroCopyLinger(int afd, NetZeroCopy &zc) : Continuation(new_ProxyMutex()), fd(afd)
+  {
+    deadline = Thread::get_hrtime() + ZERO_COPY_LINGER_TIMEOUT;
+    zero_copy.move(zc);
+    SET_HANDLER(&ZeroCopyLinger::mainEvent);
+  }
+
+  int
+  mainEvent(int /* event ATS_UNUSED */, Event *e)
+  {
+    if (zero_copy.reap(fd) > 0 && Thread::get_hrtime() < deadline) {
+      return EVENT_CONT;
+    }
+    Debug("socket", "zero copy linger done on fd %d, %d sends abandoned", fd, zero_copy.count);
+    zero_copy.clear();
+    socketManager.close(fd);
+    e->cancel();
+    delete this;
+    return EVENT_DONE;
+  }
+};
+
 //
 // Reschedule a UnixNetVConnection by moving it
 // onto or off of the ready_list
@@ -177,6 +310,57 @@ write_signal_error(NetHandler *nh, UnixNetVConnection *vc, int lerrno)
   return write_signal_done(VC_EVENT_ERROR, nh, vc);
 }
 
+// Read up to toread bytes from the socket into the free space of buf,
+// without filling it. Partial reads are summarized in the result.
+static int64_t
+readv_from_net(UnixNetVConnection *vc, MIOBufferAccessor &buf, int64_t toread, ProxyMutex *mutex)
+{
+  int64_t r          = 0;
+  int64_t rattempted = 0, total_read = 0;
+  unsigned niov = 0;
+  IOVec tiovec[NET_MAX_IOV];
+  IOBufferBlock *b = buf.writer()->first_write_block();
+  do {
+    niov       = 0;
+    rattempted = 0;
+    while (b && niov < NET_MAX_IOV) {
+      int64_t a = b->write_avail();
+      if (a > 0) {
+        tiovec[niov].iov_base = b->_end;
+        int64_t togo          = toread - total_read - rattempted;
+        if (a > togo) {
+          a = togo;
+        }
+        tiovec[niov].iov_len = a;
+        rattempted += a;
+        niov++;
+        if (a >= togo) {
+          break;
+        }
+      }
+      b = b->next.get();
+    }
+
+    ink_assert(niov > 0);
+    ink_assert(niov <= countof(tiovec));
+    r = socketManager.readv(vc->con.fd, &tiovec[0], niov);
+
+    NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
+
+    total_read += rattempted;
+  } while (rattempted && r == rattempted && total_read < toread);
+
+  // if we have already moved some bytes successfully, summarize in r
+  if (total_read != rattempted) {
+    if (r <= 0) {
+      r = total_read - rattempted;
+    } else {
+      r = total_read - rattempted + r;
+    }
+  }
+  return r;
+}
+
 // Read the data for a UnixNetVConnection.
 // Rescheduling the UnixNetVConnection by moving the VC
 // onto or off of the ready_list.
@@ -202,6 +386,15 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     vc->nh->free_netevent(vc);
     return;
   }
+#if TS_USE_LINUX_IO_URING
+  // Client connections are moved to the ring once they are readable. Server
+  // connections stay with epoll since they can migrate between threads.
+  if (nh->uring && !vc->uring && vc->get_context() == NET_VCONNECTION_IN && nh->uring->attach(vc)) {
+    vc->read.triggered = 0;
+    nh->read_ready_list.remove(vc);
+    return;
+  }
+#endif
   // if it is not enabled.
   if (!s->enabled || s->vio.op != VIO::READ || s->vio.is_disabled()) {
     read_disable(nh, vc);
@@ -223,48 +416,17 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   }
 
   // read data
-  int64_t rattempted = 0, total_read = 0;
-  unsigned niov = 0;
-  IOVec tiovec[NET_MAX_IOV];
   if (toread) {
-    IOBufferBlock *b = buf.writer()->first_write_block();
-    do {
-      niov       = 0;
-      rattempted = 0;
-      while (b && niov < NET_MAX_IOV) {
-        int64_t a = b->write_avail();
-        if (a > 0) {
-          tiovec[niov].iov_base = b->_end;
-          int64_t togo          = toread - total_read - rattempted;
-          if (a > togo) {
-            a = togo;
-          }
-          tiovec[niov].iov_len = a;
-          rattempted += a;
-          niov++;
-          if (a >= togo) {
-            break;
-          }
-        }
-        b = b->next.get();
-      }
-
-      ink_assert(niov > 0);
-      ink_assert(niov <= countof(tiovec));
-      r = socketManager.readv(vc->con.fd, &tiovec[0], niov);
-
-      NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
-
-      total_read += rattempted;
-    } while (rattempted && r == rattempted && total_read < toread);
-
-    // if we have already moved some bytes successfully, summarize in r
-    if (total_read != rattempted) {
-      if (r <= 0) {
-        r = total_read - rattempted;
-      } else {
-        r = total_read - rattempted + r;
-      }
+    bool appended = false;
+#if TS_USE_LINUX_IO_URING
+    if (vc->uring) {
+      // the blocks received by the ring are appended to the buffer
+      r        = nh->uring->read(vc->uring, buf.writer(), toread);
+      appended = true;
+    }
+#endif
+    if (!appended) {
+      r = readv_from_net(vc, buf, toread, mutex);
     }
     // check for errors
     if (r <= 0) {
@@ -288,7 +450,9 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     NET_SUM_DYN_STAT(net_read_bytes_stat, r);
 
     // Add data to buffer and signal continuation.
-    buf.writer()->fill(r);
+    if (!appended) {
+      buf.writer()->fill(r);
+    }
 #ifdef DEBUG
     if (buf.writer()->write_avail() <= 0) {
       Debug("iocore_net", "read_from_net, read buffer full");
@@ -884,6 +1048,9 @@ UnixNetVConnection::set_enabled(VIO *vio)
   STATE_FROM_VIO(vio)->enabled = 1;
   if (!next_inactivity_timeout_at && inactivity_timeout_in) {
     next_inactivity_timeout_at = Thread::get_hrtime() + inactivity_timeout_in;
+    if (nh) {
+      nh->update_timeout(this);
+    }
   }
 }
 
@@ -906,10 +1073,27 @@ UnixNetVConnection::net_write_io(NetHandler *nh, EThread *lthread)
 int64_t
 UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs)
 {
+#if TS_USE_LINUX_IO_URING
+  if (this->uring) {
+    // The send is queued in the ring, its result comes with the next call.
+    int64_t r = nh->uring->send(this->uring, buf.reader(), towrite);
+    if (r > 0) {
+      buf.reader()->consume(r);
+      total_written += r;
+    }
+    needs |= EVENTIO_WRITE;
+    return r;
+  }
+#endif
+
   int64_t r                  = 0;
   int64_t try_to_write       = 0;
   IOBufferReader *tmp_reader = buf.reader()->clone();
 
+  if (this->zero_copy.count > 0) {
+    this->zero_copy.reap(con.fd);
+  }
+
   do {
     IOVec tiovec[NET_MAX_IOV];
     unsigned niov = 0;
@@ -970,6 +1154,24 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
         this->con.is_connected = true;
       }
 
+    } else if (net_zero_copy_threshold > 0 && try_to_write >= net_zero_copy_threshold && this->zero_copy.enable(con.fd)) {
+      struct msghdr msg;
+
+      ink_zero(msg);
+      msg.msg_iov    = &tiovec[0];
+      msg.msg_iovlen = niov;
+
+#if HAVE_NET_ZERO_COPY
+      r = socketManager.sendmsg(con.fd, &msg, MSG_ZEROCOPY);
+#endif
+      if (r > 0) {
+        IOBufferReader *reader = buf.reader();
+        this->zero_copy.track(iobufferblock_clone(reader->block.get(), reader->start_offset, r));
+        RecIncrRawStatSum(net_rsb, this_ethread(), net_zero_copy_bytes_stat, r);
+      } else if (r == -ENOBUFS) {
+        // Out of option memory for pinning the pages, fall back to copying.
+        r = socketManager.writev(con.fd, &tiovec[0], niov);
+      }
     } else {
       r = socketManager.writev(con.fd, &tiovec[0], niov);
     }
@@ -1335,7 +1537,18 @@ UnixNetVConnection::free(EThread *t)
   // close socket fd
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
+    if (zero_copy.count > 0 && zero_copy.reap(con.fd) > 0) {
+      // The socket now belongs to the linger continuation.
+      t->schedule_every(new ZeroCopyLinger(con.fd, zero_copy), ZERO_COPY_LINGER_PERIOD);
+      con.fd = NO_FD;
+    }
   }
+  zero_copy.clear();
+#if TS_USE_LINUX_IO_URING
+  if (uring) {
+    nh->uring->detach(this);
+  }
+#endif
   con.close();
 
   clear();
@@ -1356,12 +1569,26 @@ UnixNetVConnection::apply_options()
   con.apply_options(options);
 }
 
+void
+UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
+{
+  Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
+  active_timeout_in        = timeout_in;
+  next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
+  if (nh) {
+    nh->update_timeout(this);
+  }
+}
+
 TS_INLINE void
 UnixNetVConnection::set_inactivity_timeout(ink_hrtime timeout_in)
 {
   Debug("socket", "Set inactive timeout=%" PRId64 ", for NetVC=%p", timeout_in, this);
   inactivity_timeout_in      = timeout_in;
   next_inactivity_timeout_at = (timeout_in > 0) ? Thread::get_hrtime() + inactivity_timeout_in : 0;
+  if (nh) {
+    nh->update_timeout(this);
+  }
 }
 
 TS_INLINE void
@@ -1371,6 +1598,9 @@ UnixNetVConnection::set_default_inactivity_timeout(ink_hrtime timeout_in)
   inactivity_timeout_in      = 0;
   default_inactivity_timeout = true;
   next_inactivity_timeout_at = Thread::get_hrtime() + timeout_in;
+  if (nh) {
+    nh->update_timeout(this);
+  }
 }
 
 TS_INLINE bool
@@ -1433,6 +1663,7 @@ UnixNetVConnection::migrateToCurrentThread(Continuation *cont, EThread *t)
   }
   if (netvc) {
     netvc->options = this->options;
+    netvc->zero_copy.move(this->zero_copy);
   }
   // Do not mark this closed until the end so it does not get freed by the other thread too soon
   this->do_io_close();
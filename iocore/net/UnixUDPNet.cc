@@ -52,6 +52,8 @@ UDPNetProcessor &udpNet = udpNetInternal;
 int32_t g_udp_periodicCleanupSlots;
 int32_t g_udp_periodicFreeCancelledPkts;
 int32_t g_udp_numSendRetries;
+int32_t g_udp_enable_gso = 1;
+int32_t g_udp_enable_gro = 1;
 
 //
 // Public functions
@@ -92,7 +94,8 @@ initialize_thread_for_udp_net(EThread *thread)
   g_udp_numSendRetries = g_udp_numSendRetries < 0 ? 0 : g_udp_numSendRetries;
 
   thread->set_tail_handler(nh);
-  thread->ep = static_cast<EventIO *>(ats_malloc(sizeof(EventIO)));
+  thread->busy_poll_time = HRTIME_USECONDS(net_config_busy_poll_usec);
+  thread->ep             = static_cast<EventIO *>(ats_malloc(sizeof(EventIO)));
   new (thread->ep) EventIO();
   thread->ep->type = EVENTIO_ASYNC_SIGNAL;
 #if HAVE_EVENTFD
@@ -112,6 +115,9 @@ UDPNetProcessorInternal::start(int n_upd_threads, size_t stacksize)
   pollCont_offset      = eventProcessor.allocate(sizeof(PollCont));
   udpNetHandler_offset = eventProcessor.allocate(sizeof(UDPNetHandler));
 
+  REC_ReadConfigInt32(g_udp_enable_gso, "proxy.config.udp.enable_gso");
+  REC_ReadConfigInt32(g_udp_enable_gro, "proxy.config.udp.enable_gro");
+
   ET_UDP = eventProcessor.register_event_type("ET_UDP");
   eventProcessor.schedule_spawn(&initialize_thread_for_udp_net, ET_UDP);
   eventProcessor.spawn_event_threads(ET_UDP, n_upd_threads, stacksize);
@@ -119,11 +125,128 @@ UDPNetProcessorInternal::start(int n_upd_threads, size_t stacksize)
   return 0;
 }
 
-void
-UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc)
+// Take the destination address of a datagram read with @a msg into @a toaddr, return the size of the
+// datagrams of a GRO train or 0.
+static int
+udp_parse_cmsgs(struct msghdr *msg, sockaddr_in6 *toaddr)
 {
-  UnixUDPConnection *uc = (UnixUDPConnection *)xuc;
+  int segment_size = 0;
+
+  for (auto cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+    switch (cmsg->cmsg_type) {
+#ifdef IP_PKTINFO
+    case IP_PKTINFO:
+      if (cmsg->cmsg_level == IPPROTO_IP) {
+        struct in_pktinfo *pktinfo                               = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
+        reinterpret_cast<sockaddr_in *>(toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
+      }
+      break;
+#endif
+#ifdef IP_RECVDSTADDR
+    case IP_RECVDSTADDR:
+      if (cmsg->cmsg_level == IPPROTO_IP) {
+        struct in_addr *addr                                     = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
+        reinterpret_cast<sockaddr_in *>(toaddr)->sin_addr.s_addr = addr->s_addr;
+      }
+      break;
+#endif
+#if defined(IPV6_PKTINFO) || defined(IPV6_RECVPKTINFO)
+    case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
+      if (cmsg->cmsg_level == IPPROTO_IPV6) {
+        struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
+        memcpy(toaddr->sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
+      }
+      break;
+#endif
+#ifdef UDP_GRO
+    case UDP_GRO:
+      if (cmsg->cmsg_level == SOL_UDP) {
+        memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+      }
+      break;
+#endif
+    }
+  }
+  return segment_size;
+}
+
+#if HAVE_RECVMMSG
+// Receive the datagrams of @a uc UDP_RECV_BATCH at a time and queue them onto @a uc.
+static void
+udp_recv_batch(UDPNetHandler *nh, UnixUDPConnection *uc)
+{
+  struct mmsghdr msgs[UDP_RECV_BATCH];
+  struct iovec iov[UDP_RECV_BATCH];
+  sockaddr_in6 fromaddr[UDP_RECV_BATCH];
+  uint64_t cbuf[UDP_RECV_BATCH][16];
+  sockaddr_in6 localaddr;
+  int localaddr_len = sizeof(localaddr);
+  int n, iters = 0;
+
+  if (nh->recv_buf == nullptr) {
+    nh->recv_buf = static_cast<char *>(ats_malloc(UDP_RECV_BATCH * UDP_RECV_BUF_SIZE));
+  }
+  safe_getsockname(uc->getFd(), reinterpret_cast<struct sockaddr *>(&localaddr), &localaddr_len);
+
+  do {
+    for (int i = 0; i < UDP_RECV_BATCH; ++i) {
+      struct msghdr &msg = msgs[i].msg_hdr;
+      iov[i].iov_base    = nh->recv_buf + i * UDP_RECV_BUF_SIZE;
+      iov[i].iov_len     = UDP_RECV_BUF_SIZE;
+      msg.msg_name       = &fromaddr[i];
+      msg.msg_namelen    = sizeof(fromaddr[i]);
+      msg.msg_iov        = &iov[i];
+      msg.msg_iovlen     = 1;
+      msg.msg_control    = cbuf[i];
+      msg.msg_controllen = sizeof(cbuf[i]);
+      msg.msg_flags      = 0;
+    }
+
+    do {
+      n = ::recvmmsg(uc->getFd(), msgs, UDP_RECV_BATCH, 0, nullptr);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+      break;
+    }
+
+    for (int i = 0; i < n; ++i) {
+      struct msghdr &msg = msgs[i].msg_hdr;
+      int64_t len        = msgs[i].msg_len;
+      sockaddr_in6 toaddr;
+
+      if (msg.msg_flags & MSG_TRUNC) {
+        Debug("udp-read", "The UDP packet is truncated");
+      }
+      memcpy(&toaddr, &localaddr, sizeof(toaddr));
+      int64_t segment_size = udp_parse_cmsgs(&msg, &toaddr);
+      if (segment_size <= 0) {
+        segment_size = len;
+      }
 
+      // Copy each datagram, a GRO train is split back into its datagrams, so the buffers can be read into again.
+      for (int64_t offset = 0; offset < len; offset += segment_size) {
+        int64_t size = std::min(segment_size, len - offset);
+        Ptr<IOBufferBlock> block(new_IOBufferBlock());
+        block->alloc(iobuffer_size_to_index(size, BUFFER_SIZE_INDEX_64K));
+        memcpy(block->end(), static_cast<char *>(iov[i].iov_base) + offset, size);
+        block->fill(size);
+
+        UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr[i]), ats_ip_sa_cast(&toaddr), block);
+        p->setConnection(uc);
+        uc->inQueue.push((UDPPacketInternal *)p);
+        iters++;
+      }
+    }
+  } while (n == UDP_RECV_BATCH);
+  if (iters >= 1) {
+    Debug("udp-read", "read %d at a time", iters);
+  }
+}
+#else
+// Receive the datagrams of @a uc one at a time into chains of blocks and queue them onto @a uc.
+static void
+udp_recv_single(UnixUDPConnection *uc)
+{
   // receive packet and queue onto UDPConnection.
   // don't call back connection at this time.
   int64_t r;
@@ -205,35 +328,8 @@ UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc
       }
     }
 
-    safe_getsockname(xuc->getFd(), reinterpret_cast<struct sockaddr *>(&toaddr), &toaddr_len);
-    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-      switch (cmsg->cmsg_type) {
-#ifdef IP_PKTINFO
-      case IP_PKTINFO:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_pktinfo *pktinfo                                = reinterpret_cast<struct in_pktinfo *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = pktinfo->ipi_addr.s_addr;
-        }
-        break;
-#endif
-#ifdef IP_RECVDSTADDR
-      case IP_RECVDSTADDR:
-        if (cmsg->cmsg_level == IPPROTO_IP) {
-          struct in_addr *addr                                      = reinterpret_cast<struct in_addr *>(CMSG_DATA(cmsg));
-          reinterpret_cast<sockaddr_in *>(&toaddr)->sin_addr.s_addr = addr->s_addr;
-        }
-        break;
-#endif
-#if defined(IPV6_PKTINFO) || defined(IPV6_RECVPKTINFO)
-      case IPV6_PKTINFO: // IPV6_RECVPKTINFO uses IPV6_PKTINFO too
-        if (cmsg->cmsg_level == IPPROTO_IPV6) {
-          struct in6_pktinfo *pktinfo = reinterpret_cast<struct in6_pktinfo *>(CMSG_DATA(cmsg));
-          memcpy(toaddr.sin6_addr.s6_addr, &pktinfo->ipi6_addr, 16);
-        }
-        break;
-#endif
-      }
-    }
+    safe_getsockname(uc->getFd(), reinterpret_cast<struct sockaddr *>(&toaddr), &toaddr_len);
+    udp_parse_cmsgs(&msg, &toaddr);
 
     // create packet
     UDPPacket *p = new_incoming_UDPPacket(ats_ip_sa_cast(&fromaddr), ats_ip_sa_cast(&toaddr), chain);
@@ -249,6 +345,19 @@ UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc
   if (iters >= 1) {
     Debug("udp-read", "read %d at a time", iters);
   }
+}
+#endif
+
+void
+UDPNetProcessorInternal::udp_read_from_net(UDPNetHandler *nh, UDPConnection *xuc)
+{
+  UnixUDPConnection *uc = (UnixUDPConnection *)xuc;
+
+#if HAVE_RECVMMSG
+  udp_recv_batch(nh, uc);
+#else
+  udp_recv_single(uc);
+#endif
   // if not already on to-be-called-back queue, then add it.
   if (!uc->onCallbackQueue) {
     ink_assert(uc->callback_link.next == nullptr);
@@ -614,6 +723,18 @@ UDPNetProcessor::sendto_re(Continuation *cont, void *token, int fd, struct socka
   }
 }
 
+// Let the kernel hand the datagrams read from @a fd over in GRO trains, udp_recv_batch() splits them.
+static void
+udp_enable_gro(int fd)
+{
+#if HAVE_RECVMMSG && defined(UDP_GRO)
+  int enable = 1;
+  if (g_udp_enable_gro && safe_setsockopt(fd, SOL_UDP, UDP_GRO, reinterpret_cast<char *>(&enable), sizeof(enable)) < 0) {
+    Debug("udpnet", "setsockopt for UDP_GRO failed: %s", strerror(errno));
+  }
+#endif
+}
+
 bool
 UDPNetProcessor::CreateUDPSocket(int *resfd, sockaddr const *remote_addr, Action **status, NetVCOptions &opt)
 {
@@ -697,6 +818,7 @@ UDPNetProcessor::CreateUDPSocket(int *resfd, sockaddr const *remote_addr, Action
       goto HardError;
     }
   }
+  udp_enable_gro(fd);
 
   if (local_addr.port() || !is_any_address) {
     if (-1 == socketManager.ink_bind(fd, &local_addr.sa, ats_ip_size(&local_addr.sa))) {
@@ -792,6 +914,7 @@ UDPNetProcessor::UDPBind(Continuation *cont, sockaddr const *addr, int fd, int s
       goto Lerror;
     }
   }
+  udp_enable_gro(fd);
 
   // If this is a class D address (i.e. multicast address), use REUSEADDR.
   if (ats_is_ip_multicast(addr)) {
@@ -847,8 +970,113 @@ Lerror:
   return ACTION_IO_ERROR;
 }
 
+/** The datagrams of the packets going out with one sendmmsg() call, all on the same socket.
+
+    A packet of segments becomes one message with a UDP_SEGMENT control message when the kernel
+    segments it, or a message per segment otherwise.
+ */
+struct UDPSendBatch {
+  static constexpr int MAX_MSGS = UDP_GSO_MAX_SEGMENTS;
+  static constexpr int MAX_IOV  = 4 * UDP_GSO_MAX_SEGMENTS;
+
+  struct msghdr msgs[MAX_MSGS];
+  int owner[MAX_MSGS]; ///< The index of the packet of each message.
+  uint64_t control[MAX_MSGS][4];
+  struct iovec iov[MAX_IOV];
+  int nmsg = 0;
+  int niov = 0;
+  int fd   = NO_FD;
+
+  /// Add the datagrams of @a p, the packet @a index, return false if they do not fit.
+  bool add(UDPPacketInternal *p, int index, bool gso);
+
+  void
+  clear()
+  {
+    nmsg = 0;
+    niov = 0;
+    fd   = NO_FD;
+  }
+};
+
+bool
+UDPSendBatch::add(UDPPacketInternal *p, int index, bool gso)
+{
+  int saved_nmsg   = nmsg;
+  int saved_niov   = niov;
+  bool one_message = p->segment_size == 0 || gso;
+  IOBufferBlock *b = p->chain.get();
+  int64_t offset   = 0; // into b
+
+  if (nmsg && p->conn->getFd() != fd) {
+    return false;
+  }
+
+  while (b) {
+    if (nmsg == MAX_MSGS) {
+      goto Lfull;
+    }
+
+    struct msghdr &msg = msgs[nmsg];
+    int first          = niov;
+    int64_t left       = one_message ? INT64_MAX : p->segment_size;
+    while (b && left > 0) {
+      int64_t avail = b->size() - offset;
+      if (avail <= 0) {
+        b      = b->next.get();
+        offset = 0;
+        continue;
+      }
+      if (niov == MAX_IOV) {
+        goto Lfull;
+      }
+      int64_t len        = std::min(avail, left);
+      iov[niov].iov_base = b->start() + offset;
+      iov[niov].iov_len  = len;
+      ++niov;
+      left -= len;
+      offset += len;
+    }
+    if (niov == first) {
+      break;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name    = reinterpret_cast<caddr_t>(&p->to.sa);
+    msg.msg_namelen = ats_ip_size(p->to);
+    msg.msg_iov     = &iov[first];
+    msg.msg_iovlen  = niov - first;
+#ifdef UDP_SEGMENT
+    if (p->segment_size && gso) {
+      msg.msg_control    = control[nmsg];
+      msg.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+      struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+      cm->cmsg_level     = SOL_UDP;
+      cm->cmsg_type      = UDP_SEGMENT;
+      cm->cmsg_len       = CMSG_LEN(sizeof(uint16_t));
+      memcpy(CMSG_DATA(cm), &p->segment_size, sizeof(uint16_t));
+    }
+#endif
+    owner[nmsg++] = index;
+  }
+  fd = p->conn->getFd();
+  return true;
+
+Lfull:
+  nmsg = saved_nmsg;
+  niov = saved_niov;
+  return false;
+}
+
 // send out all packets that need to be sent out as of time=now
-UDPQueue::UDPQueue() {}
+UDPQueue::UDPQueue()
+{
+#ifdef UDP_SEGMENT
+  gso = g_udp_enable_gso;
+#else
+  gso = false;
+#endif
+}
 
 UDPQueue::~UDPQueue() {}
 
@@ -911,6 +1139,10 @@ UDPQueue::SendPackets()
   int32_t bytesThisSlot = INT_MAX, bytesUsed = 0;
   int32_t bytesThisPipe, sentOne;
   int64_t pktLen;
+#if HAVE_SENDMMSG
+  UDPPacketInternal *batch[UDP_SEND_BATCH];
+  int nbatch = 0;
+#endif
 
   bytesThisSlot = INT_MAX;
 
@@ -929,17 +1161,35 @@ sendPackets:
       goto next_pkt;
     }
 
+#if HAVE_SENDMMSG
+    // The batch frees the packet once it is sent.
+    batch[nbatch++] = p;
+    if (nbatch == UDP_SEND_BATCH) {
+      SendMultipleUDPPackets(batch, nbatch);
+      nbatch = 0;
+    }
+    p = nullptr;
+#else
     SendUDPPacket(p, pktLen);
+#endif
     bytesUsed += pktLen;
     bytesThisPipe -= pktLen;
   next_pkt:
     sentOne = true;
-    p->free();
+    if (p) {
+      p->free();
+    }
 
     if (bytesThisPipe < 0) {
       break;
     }
   }
+#if HAVE_SENDMMSG
+  if (nbatch) {
+    SendMultipleUDPPackets(batch, nbatch);
+    nbatch = 0;
+  }
+#endif
 
   bytesThisSlot -= bytesUsed;
 
@@ -961,54 +1211,106 @@ sendPackets:
 void
 UDPQueue::SendUDPPacket(UDPPacketInternal *p, int32_t /* pktLen ATS_UNUSED */)
 {
-  struct msghdr msg;
-  struct iovec iov[32];
-  int real_len = 0;
-  int n, count, iov_len = 0;
+  UDPSendBatch batch;
+  int n, count;
 
   p->conn->lastSentPktStartTime = p->delivery_time;
   Debug("udp-send", "Sending %p", p);
 
-#if !defined(solaris)
-  msg.msg_control    = nullptr;
-  msg.msg_controllen = 0;
-  msg.msg_flags      = 0;
-#endif
-  msg.msg_name    = reinterpret_cast<caddr_t>(&p->to.sa);
-  msg.msg_namelen = ats_ip_size(p->to);
-  iov_len         = 0;
-
-  for (IOBufferBlock *b = p->chain.get(); b != nullptr; b = b->next.get()) {
-    iov[iov_len].iov_base = static_cast<caddr_t>(b->start());
-    iov[iov_len].iov_len  = b->size();
-    real_len += iov[iov_len].iov_len;
-    iov_len++;
+  // Platforms without sendmmsg() have no UDP GSO either, a packet of segments goes out a datagram at a time.
+  if (!batch.add(p, 0, false)) {
+    Debug("udp-send", "Dropping %p: too many blocks", p);
+    return;
   }
-  msg.msg_iov    = iov;
-  msg.msg_iovlen = iov_len;
-
-  count = 0;
-  while (true) {
-    // stupid Linux problem: sendmsg can return EAGAIN
-    n = ::sendmsg(p->conn->getFd(), &msg, 0);
-    if ((n >= 0) || ((n < 0) && (errno != EAGAIN))) {
-      // send succeeded or some random error happened.
-      if (n < 0) {
-        Debug("udp-send", "Error: %s (%d)", strerror(errno), errno);
+
+  for (int i = 0; i < batch.nmsg; ++i) {
+    count = 0;
+    while (true) {
+      // stupid Linux problem: sendmsg can return EAGAIN
+      n = ::sendmsg(p->conn->getFd(), &batch.msgs[i], 0);
+      if ((n >= 0) || ((n < 0) && (errno != EAGAIN))) {
+        // send succeeded or some random error happened.
+        if (n < 0) {
+          Debug("udp-send", "Error: %s (%d)", strerror(errno), errno);
+        }
+
+        break;
+      }
+      if (errno == EAGAIN) {
+        ++count;
+        if ((g_udp_numSendRetries > 0) && (count >= g_udp_numSendRetries)) {
+          // tried too many times; give up
+          Debug("udpnet", "Send failed: too many retries");
+          break;
+        }
       }
+    }
+  }
+}
 
-      break;
+#if HAVE_SENDMMSG
+void
+UDPQueue::SendMultipleUDPPackets(UDPPacketInternal **p, int n)
+{
+  UDPSendBatch batch;
+  struct mmsghdr msgs[UDPSendBatch::MAX_MSGS];
+  int next = 0;
+
+  while (next < n) {
+    batch.clear();
+    while (next < n && batch.add(p[next], next, gso)) {
+      p[next]->conn->lastSentPktStartTime = p[next]->delivery_time;
+      Debug("udp-send", "Sending %p", p[next]);
+      ++next;
     }
-    if (errno == EAGAIN) {
-      ++count;
-      if ((g_udp_numSendRetries > 0) && (count >= g_udp_numSendRetries)) {
-        // tried too many times; give up
-        Debug("udpnet", "Send failed: too many retries");
+    if (batch.nmsg == 0) {
+      Debug("udp-send", "Dropping %p: too many blocks", p[next]);
+      ++next;
+      continue;
+    }
+
+    for (int i = 0; i < batch.nmsg; ++i) {
+      msgs[i].msg_hdr = batch.msgs[i];
+      msgs[i].msg_len = 0;
+    }
+
+    int sent  = 0;
+    int count = 0;
+    while (sent < batch.nmsg) {
+      int r = ::sendmmsg(batch.fd, msgs + sent, batch.nmsg - sent, 0);
+      if (r > 0) {
+        sent += r;
+        continue;
+      }
+      if (errno == EAGAIN || errno == EINTR) {
+        ++count;
+        if ((g_udp_numSendRetries > 0) && (count >= g_udp_numSendRetries)) {
+          // tried too many times; give up
+          Debug("udpnet", "Send failed: too many retries");
+          break;
+        }
+        continue;
+      }
+#ifdef UDP_SEGMENT
+      if (gso && (errno == EIO || errno == EINVAL) && batch.msgs[sent].msg_controllen) {
+        // The kernel or the device cannot segment, send this packet and the ones after it a datagram at a time.
+        Note("UDP GSO failed: %s (%d), sending datagrams one at a time", strerror(errno), errno);
+        gso  = false;
+        next = batch.owner[sent];
         break;
       }
+#endif
+      // The first message failed, go on with the next one.
+      Debug("udp-send", "Error: %s (%d)", strerror(errno), errno);
+      ++sent;
     }
   }
+
+  for (int i = 0; i < n; ++i) {
+    p[i]->free();
+  }
 }
+#endif
 
 void
 UDPQueue::send(UDPPacket *p)
@@ -1054,7 +1356,8 @@ int
 UDPNetHandler::mainNetEvent(int event, Event *e)
 {
   ink_assert(trigger_event == e && event == EVENT_POLL);
-  return this->waitForActivity(net_config_poll_timeout);
+  this->waitForActivity(net_config_poll_timeout);
+  return EVENT_CONT;
 }
 
 int
@@ -1063,6 +1366,7 @@ UDPNetHandler::waitForActivity(ink_hrtime timeout)
   UnixUDPConnection *uc;
   PollCont *pc = get_UDPPollCont(this->thread);
   pc->do_poll(timeout);
+  int activity = pc->pollDescriptor->result;
 
   /* Notice: the race between traversal of newconn_list and UDPBind()
    *
@@ -1155,7 +1459,7 @@ UDPNetHandler::waitForActivity(ink_hrtime timeout)
     }
   }
 
-  return EVENT_CONT;
+  return activity;
 }
 
 void
@@ -1813,6 +1813,18 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   Debug("hugepages", "ats_pagesize reporting %zu", ats_pagesize());
   Debug("hugepages", "ats_hugepage_size reporting %zu", ats_hugepage_size());
 
+  // Give each NUMA node free lists of its own, before the event threads start using them.
+  REC_ReadConfigInteger(enabled, "proxy.config.allocator.numa_aware");
+#if TS_USE_HWLOC
+  if (enabled) {
+    int nodes = hwloc_get_nbobjs_by_type(ink_get_topology(), HWLOC_OBJ_NODE);
+    if (nodes > 1) {
+      Note("using NUMA aware free lists for %d NUMA nodes", nodes);
+    }
+    ink_freelist_init_numa(nodes);
+  }
+#endif
+
   if (!num_accept_threads) {
     REC_ReadConfigInteger(num_accept_threads, "proxy.config.accept_threads");
   }
@@ -2154,6 +2166,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     // "Task" processor, possibly with its own set of task threads
     tasksProcessor.register_event_type();
     eventProcessor.thread_group[ET_TASK]._afterStartCallback = task_threads_started_callback;
+    eventProcessor.thread_group[ET_TASK]._steal              = REC_ConfigReadInteger("proxy.config.task_threads.work_stealing") != 0;
     tasksProcessor.start(num_task_threads, stacksize);
 
     if (netProcessor.socks_conf_stuff->accept_enabled) {
@@ -40,6 +40,7 @@
 #include <cassert>
 #include <memory.h>
 #include <cstdlib>
+#include <new>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/mman.h>
@@ -94,6 +95,9 @@ static const ink_freelist_ops *default_ops = &freelist_ops;
 static ink_freelist_list *freelists                = nullptr;
 static const ink_freelist_ops *freelist_global_ops = default_ops;
 
+static int freelist_nodes                   = 0;  // NUMA nodes with lists of their own, 0 if not NUMA aware.
+static thread_local int freelist_thread_node = -1; // Node of the calling thread, -1 for the shared list.
+
 const InkFreeListOps *
 ink_freelist_malloc_ops()
 {
@@ -116,6 +120,67 @@ ink_freelist_init_ops(int nofl_class, int nofl_proxy)
   freelist_global_ops = (nofl_class || nofl_proxy) ? ink_freelist_malloc_ops() : ink_freelist_freelist_ops();
 }
 
+static void
+freelist_init_nodes(InkFreeList *f)
+{
+  f->nodes = static_cast<InkFreeListNode *>(ats_memalign(alignof(InkFreeListNode), freelist_nodes * sizeof(InkFreeListNode)));
+  for (int i = 0; i < freelist_nodes; ++i) {
+    new (&f->nodes[i]) InkFreeListNode();
+    SET_FREELIST_POINTER_VERSION(f->nodes[i].head, FROM_PTR(0), 0);
+  }
+}
+
+void
+ink_freelist_init_numa(int nodes)
+{
+  // Free lists are created by static initializers, so those made so far get their nodes here.
+  ink_release_assert(freelist_nodes == 0);
+  if (nodes > 1) {
+    freelist_nodes = nodes;
+    for (ink_freelist_list *fll = freelists; fll; fll = fll->next) {
+      freelist_init_nodes(fll->fl);
+    }
+  }
+}
+
+void
+ink_freelist_set_thread_node(int node)
+{
+  freelist_thread_node = node < freelist_nodes ? node : -1;
+}
+
+// The items on the calling thread's node, nullptr if it uses the shared list.
+static inline InkFreeListNode *
+freelist_node(InkFreeList *f)
+{
+  return freelist_thread_node >= 0 && f->nodes ? &f->nodes[freelist_thread_node] : nullptr;
+}
+
+// Put the pages of a new chunk on @a node before they are touched.
+static void
+freelist_bind(void *addr, size_t len, int node)
+{
+#if TS_USE_HWLOC
+  hwloc_obj_t obj = hwloc_get_obj_by_type(ink_get_topology(), HWLOC_OBJ_NODE, node);
+  int res         = -1;
+  if (obj) {
+#if HWLOC_API_VERSION >= 0x20000
+    res = hwloc_set_area_membind(ink_get_topology(), addr, len, obj->nodeset, HWLOC_MEMBIND_BIND,
+                                 HWLOC_MEMBIND_BYNODESET | HWLOC_MEMBIND_MIGRATE);
+#else
+    res = hwloc_set_area_membind_nodeset(ink_get_topology(), addr, len, obj->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_MIGRATE);
+#endif
+  }
+  if (res != 0) {
+    Debug(DEBUG_TAG, "Unable to bind %zu bytes at %p to NUMA node %d", len, addr, node);
+  }
+#else
+  (void)addr;
+  (void)len;
+  (void)node;
+#endif
+}
+
 void
 ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32_t chunk_size, uint32_t alignment)
 {
@@ -152,6 +217,9 @@ ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32
   }
   Debug(DEBUG_TAG "_init", "<%s> Chunk Size request/actual (%" PRIu32 "/%" PRIu32 ")", name, chunk_size, f->chunk_size);
   SET_FREELIST_POINTER_VERSION(f->head, FROM_PTR(0), 0);
+  if (freelist_nodes) {
+    freelist_init_nodes(f);
+  }
 
   *fl = f;
 }
@@ -197,9 +265,11 @@ freelist_new(InkFreeList *f)
   head_p item;
   head_p next;
   int result = 0;
+  InkFreeListNode *node = freelist_node(f);
+  head_p *head          = node ? &node->head : &f->head;
 
   do {
-    INK_QUEUE_LD(item, f->head);
+    INK_QUEUE_LD(item, *head);
     if (TO_PTR(FREELIST_POINTER(item)) == nullptr) {
       uint32_t i;
       void *newp        = nullptr;
@@ -219,6 +289,10 @@ freelist_new(InkFreeList *f)
       if (f->advice) {
         ats_madvise(static_cast<caddr_t>(newp), INK_ALIGN(alloc_size, alignment), f->advice);
       }
+      if (node) {
+        freelist_bind(newp, INK_ALIGN(alloc_size, alignment), freelist_thread_node);
+        ink_atomic_increment(reinterpret_cast<int *>(&node->allocated), f->chunk_size);
+      }
       SET_FREELIST_POINTER_VERSION(item, newp, 0);
 
       ink_atomic_increment(reinterpret_cast<int *>(&f->allocated), f->chunk_size);
@@ -237,7 +311,7 @@ freelist_new(InkFreeList *f)
 
     } else {
       SET_FREELIST_POINTER_VERSION(next, *ADDRESS_OF_NEXT(TO_PTR(FREELIST_POINTER(item)), 0), FREELIST_VERSION(item) + 1);
-      result = ink_atomic_cas(&f->head.data, item.data, next.data);
+      result = ink_atomic_cas(&head->data, item.data, next.data);
 
 #ifdef SANITY
       if (result) {
@@ -290,6 +364,8 @@ freelist_free(InkFreeList *f, void *item)
   head_p h;
   head_p item_pair;
   int result = 0;
+  InkFreeListNode *node = freelist_node(f);
+  head_p *head          = node ? &node->head : &f->head;
 
   // ink_assert(!((long)item&(f->alignment-1))); XXX - why is this no longer working? -bcall
 
@@ -305,7 +381,7 @@ freelist_free(InkFreeList *f, void *item)
 #endif /* DEADBEEF */
 
   while (!result) {
-    INK_QUEUE_LD(h, f->head);
+    INK_QUEUE_LD(h, *head);
 #ifdef SANITY
     if (TO_PTR(FREELIST_POINTER(h)) == item) {
       ink_abort("ink_freelist_free: trying to free item twice");
@@ -320,7 +396,7 @@ freelist_free(InkFreeList *f, void *item)
     *adr_of_next = FREELIST_POINTER(h);
     SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(item), FREELIST_VERSION(h));
     INK_MEMORY_BARRIER;
-    result = ink_atomic_cas(&f->head.data, h.data, item_pair.data);
+    result = ink_atomic_cas(&head->data, h.data, item_pair.data);
   }
 }
 
@@ -350,6 +426,8 @@ freelist_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
   head_p h;
   head_p item_pair;
   int result = 0;
+  InkFreeListNode *node = freelist_node(f);
+  head_p *list          = node ? &node->head : &f->head;
 
   // ink_assert(!((long)item&(f->alignment-1))); XXX - why is this no longer working? -bcall
 
@@ -370,7 +448,7 @@ freelist_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
 #endif /* DEADBEEF */
 
   while (!result) {
-    INK_QUEUE_LD(h, f->head);
+    INK_QUEUE_LD(h, *list);
 #ifdef SANITY
     if (TO_PTR(FREELIST_POINTER(h)) == head) {
       ink_abort("ink_freelist_free: trying to free item twice");
@@ -385,7 +463,7 @@ freelist_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
     *adr_of_next = FREELIST_POINTER(h);
     SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(head), FREELIST_VERSION(h));
     INK_MEMORY_BARRIER;
-    result = ink_atomic_cas(&f->head.data, h.data, item_pair.data);
+    result = ink_atomic_cas(&list->data, h.data, item_pair.data);
   }
 }
 
@@ -474,6 +552,24 @@ ink_freelists_dump(FILE *f)
   }
   fprintf(f, " %18" PRIu64 " | %18" PRIu64 " |            | TOTAL\n", total_allocated, total_used);
   fprintf(f, "-----------------------------------------------------------------------------------------\n");
+
+  if (freelist_nodes) {
+    // Memory in chunks bound to each NUMA node, the rest came from threads without a node.
+    fprintf(f, "     Allocated      | NUMA Node  |   Free List Name\n");
+    fprintf(f, "--------------------|------------|----------------------------------\n");
+    for (int node = 0; node < freelist_nodes; ++node) {
+      uint64_t node_allocated = 0;
+      for (fll = freelists; fll; fll = fll->next) {
+        uint64_t a = static_cast<uint64_t>(fll->fl->nodes[node].allocated) * static_cast<uint64_t>(fll->fl->type_size);
+        if (a) {
+          fprintf(f, " %18" PRIu64 " | %10d | memory/%s\n", a, node, fll->fl->name ? fll->fl->name : "<unknown>");
+          node_allocated += a;
+        }
+      }
+      fprintf(f, " %18" PRIu64 " | %10d | TOTAL\n", node_allocated, node);
+    }
+    fprintf(f, "-----------------------------------------------------------------------------------------\n");
+  }
 }
 
 void
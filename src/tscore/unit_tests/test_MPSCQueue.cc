@@ -0,0 +1,107 @@
+/** @file
+
+    Unit tests for MPSCQueue
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "tscore/MPSCQueue.h"
+#include "catch.hpp"
+
+namespace
+{
+struct Item {
+  int producer = 0;
+  int seq      = 0;
+  LINK(Item, link);
+};
+
+using ItemQueue = MPSCQueue<Item>;
+} // namespace
+
+TEST_CASE("MPSCQueue order", "[libts][MPSCQueue]")
+{
+  ItemQueue q;
+  Item items[3];
+
+  CHECK(q.empty());
+  CHECK(q.pop() == nullptr);
+  for (auto &i : items) {
+    q.push(&i);
+  }
+  CHECK(!q.empty());
+  CHECK(q.pop() == &items[0]);
+  CHECK(q.pop() == &items[1]);
+  q.push(&items[0]);
+  CHECK(q.pop() == &items[2]);
+  CHECK(q.pop() == &items[0]);
+  CHECK(q.pop() == nullptr);
+  CHECK(q.empty());
+
+  // An item taken out can go back in right away.
+  q.push(&items[1]);
+  CHECK(q.pop() == &items[1]);
+  q.push(&items[1]);
+  CHECK(q.pop() == &items[1]);
+  CHECK(q.empty());
+}
+
+TEST_CASE("MPSCQueue concurrent producers", "[libts][MPSCQueue]")
+{
+  constexpr int PRODUCERS = 4;
+  constexpr int ITEMS     = 50000;
+
+  ItemQueue q;
+  std::vector<std::vector<Item>> items(PRODUCERS, std::vector<Item>(ITEMS));
+  std::atomic<int> running{PRODUCERS};
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < PRODUCERS; ++p) {
+    producers.emplace_back([&, p]() {
+      for (int i = 0; i < ITEMS; ++i) {
+        items[p][i].producer = p;
+        items[p][i].seq      = i;
+        q.push(&items[p][i]);
+      }
+      --running;
+    });
+  }
+
+  // Items of each producer come out once each and in the order it pushed them.
+  std::vector<int> next(PRODUCERS, 0);
+  int out_of_order = 0;
+  int taken        = 0;
+  while (running > 0 || !q.empty()) {
+    if (Item *i = q.pop()) {
+      out_of_order += i->seq != next[i->producer];
+      next[i->producer] = i->seq + 1;
+      ++taken;
+    }
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+
+  CHECK(out_of_order == 0);
+  CHECK(taken == PRODUCERS * ITEMS);
+}
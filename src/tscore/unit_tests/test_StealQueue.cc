@@ -0,0 +1,98 @@
+/** @file
+
+    Unit tests for StealQueue
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <thread>
+#include <vector>
+
+#include "tscore/StealQueue.h"
+#include "catch.hpp"
+
+TEST_CASE("StealQueue order and bounds", "[libts][StealQueue]")
+{
+  StealQueue<int, 4> q;
+  int v[5] = {0, 1, 2, 3, 4};
+
+  CHECK(q.empty());
+  CHECK(q.take() == nullptr);
+  for (int i = 0; i < 4; ++i) {
+    REQUIRE(q.push(&v[i]));
+  }
+  CHECK(q.size() == 4);
+  CHECK(!q.push(&v[4]));
+
+  CHECK(q.take() == &v[0]);
+  REQUIRE(q.push(&v[4]));
+  for (int i = 1; i < 5; ++i) {
+    CHECK(q.take() == &v[i]);
+  }
+  CHECK(q.take() == nullptr);
+  CHECK(q.empty());
+}
+
+TEST_CASE("StealQueue concurrent takers", "[libts][StealQueue]")
+{
+  constexpr int ITEMS   = 200000;
+  constexpr int THIEVES = 3;
+
+  StealQueue<int, 64> q;
+  std::vector<int> items(ITEMS);
+  std::vector<int> seen(ITEMS, 0);
+  std::atomic<bool> done{false};
+
+  // Each item is taken exactly once, no matter who takes it.
+  auto take_all = [&]() {
+    for (;;) {
+      bool last = done.load();
+      while (int *p = q.take()) {
+        ++seen[p - items.data()];
+      }
+      if (last) {
+        break;
+      }
+      std::this_thread::yield();
+    }
+  };
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < THIEVES; ++i) {
+    thieves.emplace_back(take_all);
+  }
+  for (int i = 0; i < ITEMS; ++i) {
+    while (!q.push(&items[i])) {
+      if (int *p = q.take()) {
+        ++seen[p - items.data()];
+      }
+    }
+  }
+  done = true;
+  for (auto &t : thieves) {
+    t.join();
+  }
+  take_all();
+
+  int wrong = 0;
+  for (int n : seen) {
+    wrong += n != 1;
+  }
+  CHECK(wrong == 0);
+}
@@ -0,0 +1,144 @@
+/** @file
+
+    Unit tests for TimerWheel
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <random>
+#include <vector>
+
+#include "tscore/TimerWheel.h"
+#include "catch.hpp"
+
+struct T {
+  ink_hrtime when  = 0; // when the test wants it
+  ink_hrtime fired = 0;
+  TimerWheelLink<T> link;
+};
+
+using Wheel = TimerWheel<T, &T::link>;
+
+static const ink_hrtime TICK  = HRTIME_MSECONDS(10);
+static const ink_hrtime START = HRTIME_SECONDS(1000000) + 3;
+
+TEST_CASE("TimerWheel fires on time", "[libts][TimerWheel]")
+{
+  Wheel w;
+  w.init(TICK, START);
+
+  // Delays on all the levels.
+  std::vector<ink_hrtime> delays = {0, 1, TICK, TICK + 1, 255 * TICK, 256 * TICK, 300 * TICK, 65536 * TICK + 7,
+                                    HRTIME_HOURS(30)};
+  std::vector<T> items(delays.size());
+  for (size_t i = 0; i < delays.size(); ++i) {
+    items[i].when = START + delays[i];
+    w.schedule(&items[i], items[i].when);
+  }
+  REQUIRE(w.size() == delays.size());
+
+  ink_hrtime now = START;
+  while (w.size() && now < START + HRTIME_HOURS(31)) {
+    now += TICK;
+    w.advance(now, [&](T *t) { t->fired = now; });
+  }
+  for (auto &t : items) {
+    CHECK(t.fired >= t.when);
+    CHECK(t.fired < t.when + 2 * TICK);
+    CHECK(Wheel::due(&t) == 0);
+  }
+}
+
+TEST_CASE("TimerWheel cancel and reschedule", "[libts][TimerWheel]")
+{
+  Wheel w;
+  w.init(TICK, START);
+
+  T a, b, c;
+  w.schedule(&a, START + HRTIME_SECONDS(10));
+  w.schedule(&b, START + HRTIME_SECONDS(10));
+  w.schedule(&c, START + HRTIME_SECONDS(10));
+  w.cancel(&b);
+  w.cancel(&b);
+  w.schedule(&c, START + HRTIME_SECONDS(1));
+  REQUIRE(w.size() == 2);
+
+  std::vector<T *> fired;
+  auto record = [&](T *t) { fired.push_back(t); };
+  CHECK(w.advance(START + HRTIME_SECONDS(2), record) == 1);
+  REQUIRE(fired.size() == 1);
+  CHECK(fired[0] == &c);
+
+  // An item due in the past is due at the next tick.
+  w.schedule(&c, START);
+  CHECK(w.advance(START + HRTIME_SECONDS(2), record) == 0);
+  CHECK(w.advance(START + HRTIME_SECONDS(2) + TICK, record) == 1);
+
+  // Items rescheduled by the callback are not taken out again in the same tick.
+  ink_hrtime tick_a = (START + HRTIME_SECONDS(10) + TICK - 1) / TICK * TICK;
+  int rescheduled   = 0;
+  CHECK(w.advance(tick_a, [&](T *t) {
+    if (rescheduled++ == 0) {
+      w.schedule(t, START);
+    }
+  }) == 1);
+  CHECK(w.size() == 1);
+  CHECK(w.advance(tick_a + TICK, record) == 1);
+  CHECK(w.size() == 0);
+}
+
+TEST_CASE("TimerWheel random", "[libts][TimerWheel]")
+{
+  Wheel w;
+  w.init(TICK, START);
+
+  std::mt19937 rng(42);
+  std::vector<T> items(2000);
+  ink_hrtime now = START;
+  for (auto &t : items) {
+    t.when = now + rng() % HRTIME_SECONDS(900);
+    w.schedule(&t, t.when);
+  }
+  // Move a few around, cancel others.
+  for (size_t i = 0; i < items.size(); i += 7) {
+    if (i % 2) {
+      w.cancel(&items[i]);
+      items[i].when = 0;
+    } else {
+      items[i].when = now + rng() % HRTIME_SECONDS(60);
+      w.schedule(&items[i], items[i].when);
+    }
+  }
+
+  while (w.size()) {
+    now += HRTIME_MSECONDS(rng() % 1000);
+    w.advance(now, [&](T *t) {
+      CHECK(t->when <= now);
+      t->fired = now;
+    });
+  }
+  for (auto &t : items) {
+    if (t.when) {
+      CHECK(t.fired >= t.when);
+      CHECK(t.fired < t.when + HRTIME_SECONDS(1) + TICK);
+    } else {
+      CHECK(t.fired == 0);
+    }
+  }
+}
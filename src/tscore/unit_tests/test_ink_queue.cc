@@ -0,0 +1,67 @@
+/** @file
+
+    Unit tests for the NUMA aware free lists in ink_queue.cc
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tscore/ink_queue.h"
+#include "catch.hpp"
+
+TEST_CASE("ink_freelist NUMA nodes", "[libts][ink_queue]")
+{
+  // Lists made before and after the nodes are set up both get them.
+  InkFreeList *before = ink_freelist_create("numa_before", 64, 4, 8);
+  ink_freelist_init_numa(2);
+  InkFreeList *after = ink_freelist_create("numa_after", 64, 4, 8);
+
+  for (InkFreeList *fl : {before, after}) {
+    REQUIRE(fl->nodes != nullptr);
+    uint32_t chunk = fl->chunk_size;
+
+    // Each node fills its list from chunks of its own.
+    ink_freelist_set_thread_node(0);
+    void *a = ink_freelist_new(fl);
+    CHECK(fl->nodes[0].allocated == chunk);
+    CHECK(fl->nodes[1].allocated == 0);
+    ink_freelist_free(fl, a);
+
+    ink_freelist_set_thread_node(1);
+    void *b = ink_freelist_new(fl);
+    CHECK(b != a);
+    CHECK(fl->nodes[1].allocated == chunk);
+    ink_freelist_free(fl, b);
+
+    // Items go back to the list of the node they were freed on.
+    ink_freelist_set_thread_node(0);
+    CHECK(ink_freelist_new(fl) == a);
+    ink_freelist_free(fl, a);
+
+    // Threads without a node, or with one that is out of range, use the shared list.
+    ink_freelist_set_thread_node(2);
+    void *c = ink_freelist_new(fl);
+    CHECK(c != a);
+    CHECK(c != b);
+    CHECK(fl->allocated == 3 * chunk);
+    CHECK(fl->nodes[0].allocated + fl->nodes[1].allocated == 2 * chunk);
+    ink_freelist_free(fl, c);
+    CHECK(fl->used == 0);
+  }
+  ink_freelist_set_thread_node(-1);
+}